@@ -1,7 +1,10 @@
 #include "res.h"
 #include <main/io.h>
+#include <main/dmaq.h>
 #include <main/memmap.h>
+#include <main/sprite.h>
 #include <main/vdp.h>
+#include <main/vdpreg.h>
 #include <memory.h>
 #include <system.h>
 
@@ -28,51 +31,25 @@ void read_inputs()
   p2_prev = p2_hold;
 }
 
-// copy of VDP registers in memory
-// these need to be updated to the VDP whenever they are updated
-u16    vdp_regs[18];
-Sprite sprites[80];
-
-void update_vdp_regs()
-{
-  for (u8 i = 0; i < 18; ++i)
-    vdp_ctrl = vdp_regs[i];
-}
-
 // copy of color RAM in memory
 u16 cram[64];
 
 void update_cram_line(u8 pal_line)
 {
   pal_line <<= 4;
-  vdp_ctrl_32 = to_vdp_addr(pal_line) | CRAM_W;
-  u16 * ptr_pal_line = cram + pal_line;
-  for (u8 i = 0; i < 16; ++i)
-    vdp_data = *ptr_pal_line++;
+  vdp_dma_xfer_c(cram + pal_line, to_vdp_addr(pal_line << 1) | CRAM_W, 16);
 }
 
 void update_cram()
 {
-  vdp_ctrl_32 = to_vdp_addr(0) | CRAM_W;
-  u16 * ptr_pal_line = cram;
-  for (u8 i = 0; i < 64; ++i)
-    vdp_data = *ptr_pal_line++;
+  vdp_dma_xfer_c(cram, to_vdp_addr(0) | CRAM_W, 64);
 }
 
 void clear_vram()
 {
-  for (u16 i = 0; i < (0x10000 / 4); ++i)
-    vdp_data_32 = 0;
-}
-
-void update_sprites()
-{
-  vdp_ctrl_32 = to_vdp_addr(SPRITE_TBL_ADDR) | VRAM_W;
-  for (u8 i = 0; i < 80; ++i)
-  {
-    vdp_data_32 = ((SpriteEx) sprites[i]).as_u32[0];
-    vdp_data_32 = ((SpriteEx) sprites[i]).as_u32[1];
-  }
+  // a count of 0 fills all 64KB
+  vdp_dma_fill_c(to_vdp_addr(0) | VRAM_W, 0, 0);
+  vdp_dma_fill_c(to_vdp_addr(0) | VSRAM_W, 80, 0);
 }
 
 __attribute__((interrupt)) void INT2_EXT()
@@ -91,7 +68,6 @@ u8            vblank_flags;
 
 #define vblank_skip_updates    (1 << 0)
 #define vblank_update_cram     (1 << 1)
-#define vblank_update_vdp_regs (1 << 2)
 
 __attribute__((interrupt)) void INT6_VBLANK()
 {
@@ -100,8 +76,9 @@ __attribute__((interrupt)) void INT6_VBLANK()
     goto vblank_done;
   if (vblank_flags & vblank_update_cram)
     update_cram();
-  if (vblank_flags & vblank_update_vdp_regs)
-    update_vdp_regs();
+  // changed VDP registers are written as needed
+  vdpreg_flush_c();
+  dmaq_flush_c();
 
 vblank_done:
   ++vblank_counter;
@@ -115,7 +92,7 @@ vblank_done:
 #define VIDEO_SIGNAL 0
 #endif
 
-u16 const default_vdp_regs[] = {
+vdp_reg const default_vdp_regs[] = {
   VDP_REG_MODE1 | VDP_HICOLOR_ENABLE,
   VDP_REG_MODE2 | VDP_MD_DISPLAY_MODE | VDP_VBLANK_ENABLE | VIDEO_SIGNAL |
     VDP_DISPLAY_ENABLE,
@@ -153,10 +130,13 @@ void main()
   disable_interrupts();
   vblank_done = false;
   vblank_counter = 0;
-  memcpy16(default_vdp_regs, vdp_regs, 18);
-  update_vdp_regs();
+  vdpreg_load(default_vdp_regs, sizeof(default_vdp_regs) / sizeof(vdp_reg));
+  vdpreg_flush_c();
 
-  // note: seems to be important to set up vdp_regs first, then clear vram
+  // the VRAM clear and the uploads below are made by DMA
+  vdpreg_write(VDP_REG_MODE2, vdpreg_get(VDP_REG_MODE2) | VDP_DMA_ENABLE);
+
+  // note: seems to be important to set up the VDP first, then clear vram
   clear_vram();
 
   cram[0] = 0x0000;
@@ -168,77 +148,28 @@ void main()
   update_cram();
 
   init_joypads();
-  vdp_regs[1] |= VDP_DMA_ENABLE;
-  vdp_ctrl = vdp_regs[1];
-  vdp_dma_transfer(
-    res_basic_font.data,
-    to_vdp_addr(tile_offset(0x20)),
-    (res_basic_font.size << 1));
-  vdp_dma_transfer(
-    res_letters.data, to_vdp_addr(tile_offset(0x60)), (res_letters.size << 1));
-  vdp_regs[1] &= ~VDP_DMA_ENABLE;
-  vdp_ctrl = vdp_regs[1];
-
-  u16 base_pos_x = 175;
-  u16 base_pos_y = 200;
-
-  sprites[0].pos_x = base_pos_x;
-  sprites[0].pos_y = base_pos_y;
-  sprites[0].tile = 96;
-  sprites[0].width = 3;
-  sprites[0].height = 2;
-  sprites[0].palette = 1;
-  sprites[0].next = 1;
-
-  sprites[1].pos_x = sprites[0].pos_x + 32;
-  sprites[1].pos_y = base_pos_y;
-  sprites[1].tile = 108;
-  sprites[1].width = 3;
-  sprites[1].height = 2;
-  sprites[1].palette = 1;
-  sprites[1].next = 2;
-
-  sprites[2].pos_x = sprites[1].pos_x + 32;
-  sprites[2].pos_y = base_pos_y;
-  sprites[2].tile = 120;
-  sprites[2].width = 3;
-  sprites[2].height = 2;
-  sprites[2].palette = 1;
-  sprites[2].next = 3;
-
-  sprites[3].pos_x = sprites[2].pos_x + 32;
-  sprites[3].pos_y = base_pos_y;
-  sprites[3].tile = 132;
-  sprites[3].width = 3;
-  sprites[3].height = 2;
-  sprites[3].palette = 1;
-  sprites[3].next = 4;
-
-  sprites[4].pos_x = sprites[3].pos_x + 32;
-  sprites[4].pos_y = base_pos_y;
-  sprites[4].tile = 144;
-  sprites[4].width = 3;
-  sprites[4].height = 2;
-  sprites[4].palette = 1;
-  sprites[4].next = 5;
-
-  sprites[5].pos_x = sprites[4].pos_x + 32;
-  sprites[5].pos_y = base_pos_y;
-  sprites[5].tile = 108;
-  sprites[5].width = 3;
-  sprites[5].height = 2;
-  sprites[5].palette = 1;
-  sprites[5].next = 6;
-
-  sprites[6].pos_x = sprites[5].pos_x + 32;
-  sprites[6].pos_y = base_pos_y;
-  sprites[6].tile = 156;
-  sprites[6].width = 3;
-  sprites[6].height = 2;
-  sprites[6].palette = 1;
-  sprites[6].next = 0;
-
-  update_sprites();
+  vdp_dma_xfer_c(res_basic_font.data,
+                 to_vdp_addr(tile_offset(0x20)) | VRAM_W,
+                 (res_basic_font.size << 1));
+  vdp_dma_xfer_c(res_letters.data,
+                 to_vdp_addr(tile_offset(0x60)) | VRAM_W,
+                 (res_letters.size << 1));
+
+  // DMA stays enabled for the DMA queue, which sends the sprite table
+  dmaq_init_c(vdpreg_get(VDP_REG_MODE2), vdpreg_get(VDP_REG_MODE4));
+  spr_init_c(
+    vdpreg_get(VDP_REG_MODE2), vdpreg_get(VDP_REG_MODE4), SPRITE_TBL_ADDR);
+
+  // sprite positions are on screen, without the 128 pixel offset of the
+  // sprite table
+  s16 base_pos_x = 175 - 128;
+  s16 base_pos_y = 200 - 128;
+  s16 letter_y[7];
+  for (u8 i = 0; i < 7; ++i)
+    letter_y[i] = base_pos_y;
+
+  // first tile of each letter of MEGADEV
+  static u16 const letter_tiles[] = {96, 108, 120, 132, 144, 108, 156};
 
   enable_interrupts();
 
@@ -266,20 +197,8 @@ void main()
 
     if (wait >= 1)
     {
-      sprites[0].pos_x = base_pos_x;
-      sprites[0].pos_y = base_pos_y + (sintab[sin_pos] >> 4);
-      sprites[1].pos_x = sprites[0].pos_x + 32;
-      sprites[1].pos_y = base_pos_y + (sintab[sin_pos + 8] >> 4);
-      sprites[2].pos_x = sprites[1].pos_x + 32;
-      sprites[2].pos_y = base_pos_y + (sintab[sin_pos + 16] >> 4);
-      sprites[3].pos_x = sprites[2].pos_x + 32;
-      sprites[3].pos_y = base_pos_y + (sintab[sin_pos + 24] >> 4);
-      sprites[4].pos_x = sprites[3].pos_x + 32;
-      sprites[4].pos_y = base_pos_y + (sintab[sin_pos + 32] >> 4);
-      sprites[5].pos_x = sprites[4].pos_x + 32;
-      sprites[5].pos_y = base_pos_y + (sintab[sin_pos + 40] >> 4);
-      sprites[6].pos_x = sprites[5].pos_x + 32;
-      sprites[6].pos_y = base_pos_y + (sintab[sin_pos + 48] >> 4);
+      for (u8 i = 0; i < 7; ++i)
+        letter_y[i] = base_pos_y + (sintab[(u8) (sin_pos + (i << 3))] >> 4);
       sin_pos += 8;
       wait = 0;
     }
@@ -287,6 +206,13 @@ void main()
     {
       wait++;
     }
-    update_sprites();
+
+    spr_begin_c();
+    for (u8 i = 0; i < 7; ++i)
+      spr_add_c(&res_letter_layout,
+                base_pos_x + (i << 5),
+                letter_y[i],
+                SPR_PAL(1) | letter_tiles[i]);
+    spr_end_c();
   }
 }
@@ -1,6 +1,7 @@
 #ifndef RES_H
 #define RES_H
 
+#include "main/sprite.h"
 #include "types.h"
 
 typedef struct
@@ -14,6 +15,8 @@ extern DataChunk const res_letters;
 
 extern u16 const res_megadev_pal[16];
 
+extern SprLayout const res_letter_layout;
+
 extern s16 const sintab[256];
 
 #endif
@@ -8,3 +8,6 @@ FILE "megadev_letters.md.chr", res_letters
 
 GLABEL res_megadev_pal
 .incbin "megadev.md.pal"
+
+GLABEL res_letter_layout
+.incbin "letter.mspr"
@@ -1,6 +1,8 @@
 #include <main/bios.h>
+#include <main/dmaq.h>
 #include <main/io.h>
 #include <main/memmap.h>
+#include <main/scroll.h>
 #include <main/vdp.h>
 #include <math.h>
 #include <types.h>
@@ -27,11 +29,22 @@ void null_func()
 void vblank_user()
 {
   bios_copy_sprlist();
+  // The Boot ROM leaves DMA disabled in Mode Register 2 outside of its own
+  // DMA routines, so it is enabled only for the flush
+  vdp_ctrl_16 = bios_vdp_regs[1] | VDP_DMA_ENABLE;
+  dmaq_flush_c();
+  vdp_ctrl_16 = bios_vdp_regs[1];
 }
 
 void (*spr_funcs[2])() = {null_func, null_func};
 
-const vdp_cmd vdpptr_scroll = to_vdp_addr((BIOS_VDP_DEFAULT_HSCROLL)) | VRAM_W;
+// The buildings scroll as one, while the far background is split into bands
+// which scroll faster toward the bottom of the screen
+ScrollBand const city_bands[] = {
+  {.first = 0, .count = 224, .factor = 0x00E6, .plane = 0},
+  {.first = 0, .count = 80, .factor = 0x0066, .plane = 1},
+  {.first = 80, .count = 144, .factor = 0x0066, .slope = 0x0001, .plane = 1},
+  {.first = SCROLL_END}};
 
 /*
   We mark this is as noreturn since this is an infinite loop that will
@@ -65,9 +78,15 @@ __attribute__((noreturn)) void main()
   // The load VDP regs Boot ROM routines expect a zero terminated array of
   // raw register values
   // See the documentation on BIOS_LOAD_VDP_REGS for more
-  vdp_reg const vdp_planewidth_reg[] = {VDP_REG_PL_SIZE | VDP_PL_32x64, 0};
+  // We also switch to per line horizontal scrolling for the parallax
+  vdp_reg const vdp_planewidth_reg[] = {
+    VDP_REG_PL_SIZE | VDP_PL_32x64, VDP_REG_MODE3 | VDP_HSCROLL_PIXEL, 0};
   bios_load_vdp_regs(vdp_planewidth_reg);
 
+  // The scroll tables are sent by DMA during VBlank, through the DMA queue
+  dmaq_init_c(bios_vdp_regs[1], bios_vdp_regs[12]);
+  scroll_init_c(bios_vdp_regs[1], BIOS_VDP_DEFAULT_HSCROLL);
+
   // load the palettes
   // In general, use the to_vdp_addr macro for converting a VRAM address to the
   // VDP compatible format. It is written so that constant values will be
@@ -111,8 +130,7 @@ __attribute__((noreturn)) void main()
 
   *bios_vblank_user = vblank_user;
 
-  uf32 scroll_a = 0.0;
-  uf32 scroll_b = 0.0;
+  u16 frame = 0;
 
   do
   {
@@ -122,13 +140,9 @@ __attribute__((noreturn)) void main()
     bios_process_entities(&sprobj_ship, bios_sprlist, 0, 0x1A);
 
     // scroll the background layers
-    scroll_a -= frac_to_uf32(0.9);
-    scroll_b -= frac_to_uf32(0.6);
-
-    // (vdp auto increment is set to 2 so we only need to set the address once)
-    vdp_ctrl_32 = vdpptr_scroll;
-    vdp_data_16 = uf32_to_int(scroll_a);
-    vdp_data_16 = uf32_to_int(scroll_b);
+    ++frame;
+    scroll_hbuild_c(city_bands, -frame, frame);
+    scroll_flush_c();
 
     if (bios_joy1_hold & PAD_RIGHT)
     {
@@ -40,7 +40,8 @@ void main()
 
   wait_2m();
 
-  memset32(0, (u32 *) WORD_RAM_2M, 0x20000 * 2);
+  // clear all 256KB of 2M Word RAM
+  memset_block_c(0, (void *) WORD_RAM_2M, 0x40000);
 
   register s16 command, param1, param2, param3, param4;
   do
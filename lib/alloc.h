@@ -0,0 +1,211 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file alloc.h
+ * @brief Arena (bump) and fixed size pool allocators
+ *
+ * @details
+ * Arenas hand out blocks from a contiguous range by simply moving a pointer
+ * upward. There is no freeing of individual blocks; instead, take a mark at
+ * the start of a scene and reset to that mark when the scene ends.
+ *
+ * Pools hand out objects of a single fixed size. Free objects are linked
+ * through their own first longword, so there is no per-object overhead. Both
+ * allocation and freeing are O(1).
+ *
+ * Be sure to include alloc.s in your module when using these.
+ */
+
+#ifndef MEGADEV__ALLOC_H
+#define MEGADEV__ALLOC_H
+
+#include "types.h"
+
+/**
+ * @var _HEAP_ORIGIN
+ * @brief Start of the unused space in MODULE_RAM (after .bss and .data)
+ * @note Provided by the linker script
+ */
+extern u8 _HEAP_ORIGIN[];
+
+/**
+ * @var _HEAP_LENGTH
+ * @brief Size of the unused space in MODULE_RAM
+ * @note Provided by the linker script; the symbol address is the value
+ */
+extern u8 _HEAP_LENGTH[];
+
+#define heap_origin ((void *) _HEAP_ORIGIN)
+#define heap_length ((u32) _HEAP_LENGTH)
+
+/**
+ * @struct Arena
+ * @brief Bump allocator state
+ */
+typedef struct Arena
+{
+  u8 * base;
+  u8 * top;
+  u8 * end;
+} Arena;
+
+/**
+ * @typedef ArenaMark
+ * @brief Saved arena position, for use with @ref arena_reset
+ */
+typedef u8 * ArenaMark;
+
+/**
+ * @struct Pool
+ * @brief Fixed size object pool state
+ */
+typedef struct Pool
+{
+  void * free;
+  u16    capacity;
+  u16    in_use;
+} Pool;
+
+/**
+ * @fn arena_init
+ * @brief Set up an arena over an existing range of memory
+ */
+static inline void arena_init(Arena * arena, void * base, u32 size)
+{
+  arena->base = (u8 *) base;
+  arena->top = (u8 *) base;
+  arena->end = (u8 *) base + size;
+}
+
+/**
+ * @fn arena_init_heap
+ * @brief Set up an arena over the unused space at the end of MODULE_RAM
+ */
+static inline void arena_init_heap(Arena * arena)
+{
+  arena_init(arena, heap_origin, heap_length);
+}
+
+/**
+ * @fn arena_alloc_c
+ * @brief Allocate a block from an arena
+ * @param size Size in bytes; rounded up to an even value
+ * @return Pointer to the block, or NULL if there is not enough space
+ */
+static inline void * arena_alloc_c(Arena * arena, u32 size)
+{
+  register u32 a0_arena asm("a0") = (u32) arena;
+  register u32 a1_block asm("a1");
+  register u32 d0_size asm("d0") = size;
+
+  asm volatile(
+    "\
+  jsr arena_alloc \n\
+		"
+    : "=a"(a1_block), "+d"(d0_size)
+    : "a"(a0_arena)
+    : "d1", "cc", "memory");
+
+  return (void *) a1_block;
+}
+
+/**
+ * @fn arena_mark
+ * @brief Get the current position of the arena
+ */
+static inline ArenaMark arena_mark(Arena const * arena)
+{
+  return arena->top;
+}
+
+/**
+ * @fn arena_reset
+ * @brief Release everything allocated since the mark was taken
+ */
+static inline void arena_reset(Arena * arena, ArenaMark mark)
+{
+  arena->top = mark;
+}
+
+/**
+ * @fn arena_clear
+ * @brief Release everything in the arena
+ */
+static inline void arena_clear(Arena * arena)
+{
+  arena->top = arena->base;
+}
+
+/**
+ * @fn arena_free_space
+ * @brief Number of bytes remaining in the arena
+ */
+static inline u32 arena_free_space(Arena const * arena)
+{
+  return (u32) (arena->end - arena->top);
+}
+
+/**
+ * @fn pool_init_c
+ * @brief Set up a pool over an existing range of memory
+ * @param storage Pointer to (size * count) bytes
+ * @param size Object size in bytes; must be even and at least 4
+ * @param count Number of objects
+ */
+static inline void
+pool_init_c(Pool * pool, void * storage, u16 size, u16 count)
+{
+  register u32 a0_pool asm("a0") = (u32) pool;
+  register u32 a1_storage asm("a1") = (u32) storage;
+  register u16 d0_size asm("d0") = size;
+  register u16 d1_count asm("d1") = count;
+
+  asm volatile(
+    "\
+  jsr pool_init \n\
+		"
+    : "+a"(a1_storage), "+d"(d1_count)
+    : "a"(a0_pool), "d"(d0_size)
+    : "cc", "memory");
+}
+
+/**
+ * @fn pool_alloc_c
+ * @brief Take an object from a pool
+ * @return Pointer to the object, or NULL if the pool is empty
+ */
+static inline void * pool_alloc_c(Pool * pool)
+{
+  register u32 a0_pool asm("a0") = (u32) pool;
+  register u32 a1_object asm("a1");
+
+  asm volatile(
+    "\
+  jsr pool_alloc \n\
+		"
+    : "=a"(a1_object)
+    : "a"(a0_pool)
+    : "d0", "cc", "memory");
+
+  return (void *) a1_object;
+}
+
+/**
+ * @fn pool_free_c
+ * @brief Return an object to the pool from which it was allocated
+ */
+static inline void pool_free_c(Pool * pool, void * object)
+{
+  register u32 a0_pool asm("a0") = (u32) pool;
+  register u32 a1_object asm("a1") = (u32) object;
+
+  asm volatile(
+    "\
+  jsr pool_free \n\
+		"
+    :
+    : "a"(a0_pool), "a"(a1_object)
+    : "cc", "memory");
+}
+
+#endif
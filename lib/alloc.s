@@ -0,0 +1,100 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file alloc.s
+ * @brief Arena (bump) and fixed size pool allocators
+ *
+ * @details
+ * See alloc.h for the structure layouts. Nothing here touches the memory
+ * being handed out (aside from the pool free list links), so these can be
+ * used on any RAM owned by the calling CPU.
+ */
+
+#include "macros.s"
+
+.section .text
+
+/**
+ * @fn arena_alloc
+ * @brief Allocate a block from an arena
+ * @param[in] A0.l Pointer to Arena
+ * @param[in] D0.l Size (in bytes); rounded up to an even value
+ * @param[out] A1.l Pointer to the allocated block (0 if out of space)
+ * @param[out] CC Block allocated
+ * @param[out] CS Out of space
+ * @clobber d0-d1
+ */
+SUB arena_alloc
+  addq.l   #1, d0
+  andi.w   #0xFFFE, d0
+  movea.l  4(a0), a1     // current top
+  move.l   a1, d1
+  add.l    d0, d1        // new top
+  cmp.l    8(a0), d1     // past the end?
+  bhi      1f
+  move.l   d1, 4(a0)
+  rts
+1:suba.l   a1, a1
+  move     #1, ccr
+  rts
+
+/**
+ * @fn pool_init
+ * @brief Build the free list for a pool
+ * @param[in] A0.l Pointer to Pool
+ * @param[in] A1.l Pointer to object storage (size * count bytes)
+ * @param[in] D0.w Object size (in bytes); must be even and at least 4
+ * @param[in] D1.w Object count
+ * @clobber d1/a1
+ */
+SUB pool_init
+  clr.l    (a0)
+  move.w   d1, 4(a0)     // capacity
+  clr.w    6(a0)         // in use
+  subq.w   #1, d1
+  bcs      2f
+  move.l   a1, (a0)      // free list head is the first object
+  PUSH     a2
+  bra      1f
+  // each free object holds a pointer to the next one
+0:lea      (a1,d0.w), a2
+  move.l   a2, (a1)
+  movea.l  a2, a1
+1:dbf      d1, 0b
+  clr.l    (a1)          // last object terminates the list
+  POP      a2
+2:rts
+
+/**
+ * @fn pool_alloc
+ * @brief Take an object from a pool
+ * @param[in] A0.l Pointer to Pool
+ * @param[out] A1.l Pointer to the object (0 if the pool is empty)
+ * @param[out] CC Object allocated
+ * @param[out] CS Pool is empty
+ * @clobber d0
+ */
+SUB pool_alloc
+  move.l   (a0), d0
+  beq      1f
+  movea.l  d0, a1
+  addq.w   #1, 6(a0)
+  move.l   (a1), (a0)    // unlink from the head
+  rts
+1:suba.l   a1, a1
+  move     #1, ccr
+  rts
+
+/**
+ * @fn pool_free
+ * @brief Return an object to a pool
+ * @param[in] A0.l Pointer to Pool
+ * @param[in] A1.l Pointer to the object
+ * @warning The object must have come from the same pool, and must not be
+ * freed more than once
+ */
+SUB pool_free
+  move.l   (a0), (a1)
+  move.l   a1, (a0)
+  subq.w   #1, 6(a0)
+  rts
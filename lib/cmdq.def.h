@@ -0,0 +1,56 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file cmdq.def.h
+ * @brief Definitions shared by the Main and Sub sides of the command queue
+ *
+ * @details
+ * A batch of commands is written by the Main CPU to a buffer in 2M Word RAM:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0      | word | Number of commands in the batch
+ * 2      | ...  | Commands
+ *
+ * Each command is a header word, with the command ID in the upper byte and the
+ * number of parameter words in the lower byte, followed by the parameters.
+ *
+ * The doorbell is a single bit in the comm flags. The Main CPU toggles its bit
+ * to announce a new batch, and the Sub CPU sets its bit to match once the batch
+ * has been drained. The bits differ while a batch is outstanding.
+ */
+
+#ifndef MEGADEV__CMDQ_DEF_H
+#define MEGADEV__CMDQ_DEF_H
+
+/**
+ * @def CMDQ_FLAG_BIT
+ * @brief Doorbell bit within each CPU's comm flags byte
+ */
+#define CMDQ_FLAG_BIT 7
+#define CMDQ_FLAG_MASK (1 << CMDQ_FLAG_BIT)
+
+/**
+ * @def CMDQ_DEFAULT_OFFSET
+ * @brief Suggested location of the queue buffer, as an offset into 2M Word RAM
+ * @details This is the last 4KB of Word RAM; it only needs to be agreed upon
+ * by both CPUs.
+ */
+#define CMDQ_DEFAULT_OFFSET 0x3F000
+#define CMDQ_DEFAULT_SIZE   0x1000
+
+/**
+ * @def CMDQ_MAX_PARAMS
+ * @brief Maximum number of parameter words per command
+ */
+#define CMDQ_MAX_PARAMS 255
+
+/*
+ * CmdqStats layout
+ */
+#define CMDQ_STATS_BATCHES   0
+#define CMDQ_STATS_MAX_BATCH 2
+#define CMDQ_STATS_COMMANDS  4
+#define CMDQ_STATS_SIZE      8
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file commsync.def.h
+ * @brief Definitions shared by the Main and Sub sides of comm register sync
+ *
+ * @details
+ * Each CPU keeps a mirror of all 16 comm words in its own memory: the eight
+ * registers it writes (COMCMD for Main, COMSTAT for Sub) and a snapshot of the
+ * eight registers written by the other CPU. Once per frame, comm_sync copies
+ * the mirrors to and from the hardware as a block.
+ *
+ * Two bits in each CPU's comm flags byte make the copy consistent:
+ *
+ * - SEND is toggled by a CPU after it has written a full block to its
+ *   outgoing registers.
+ * - ACK is set to match the other CPU's SEND bit once that block has been
+ *   copied into the local snapshot.
+ *
+ * A block is outstanding while the writer's SEND bit differs from the
+ * reader's ACK bit, and the writer does not touch its registers again until
+ * they match. The reader therefore never sees a block that is only partly
+ * written.
+ *
+ * Bits 4 and 5 are used as they are not touched by the Boot ROM library
+ * (BIOS_COMM_SYNC uses bits 0-2 and 6) or by cmdq (bit 7). The comm
+ * registers themselves are owned by the sync, so it cannot be used at the same
+ * time as rpc.
+ */
+
+#ifndef MEGADEV__COMMSYNC_DEF_H
+#define MEGADEV__COMMSYNC_DEF_H
+
+/**
+ * @def COMMSYNC_SEND_BIT
+ * @brief Toggled when a new block has been written to the outgoing registers
+ */
+#define COMMSYNC_SEND_BIT 4
+#define COMMSYNC_SEND_MASK (1 << COMMSYNC_SEND_BIT)
+
+/**
+ * @def COMMSYNC_ACK_BIT
+ * @brief Matches the other CPU's SEND bit once its block has been copied
+ */
+#define COMMSYNC_ACK_BIT 5
+#define COMMSYNC_ACK_MASK (1 << COMMSYNC_ACK_BIT)
+
+/**
+ * @def COMMSYNC_WORDS
+ * @brief Number of words in each direction
+ */
+#define COMMSYNC_WORDS 8
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file kernel.h
+ * @brief Kernel service table version check
+ *
+ * @details
+ * For modules linked against a kernel service table (see kernel.macros.s).
+ * The table version of the kernel the module was built with is recorded at
+ * link time, and can be compared against the kernel which is actually
+ * resident. For example, at the start of a module:
+ *
+ *   if (!kernel_compatible())
+ *     // ... the module was built for a different kernel ...
+ */
+
+#ifndef MEGADEV__KERNEL_H
+#define MEGADEV__KERNEL_H
+
+#include "types.h"
+
+/**
+ * @var kernel_table
+ * @brief The resident kernel service table
+ * @details The first word is the version and the second the number of
+ * entries.
+ */
+extern u16 const kernel_table[];
+
+/*
+ * Table version at link time; an absolute symbol, so its address is its
+ * value
+ */
+extern u8 const kernel_table_version[];
+
+/**
+ * @fn kernel_version
+ * @brief Version of the resident kernel service table
+ */
+static inline u16 kernel_version()
+{
+  return kernel_table[0];
+}
+
+/**
+ * @fn kernel_version_linked
+ * @brief Version of the kernel service table the module was linked against
+ */
+static inline u16 kernel_version_linked()
+{
+  return (u16) (u32) kernel_table_version;
+}
+
+/**
+ * @fn kernel_compatible
+ * @brief Check that the resident kernel provides every service the module
+ * was linked against
+ * @details The major versions must match and the resident minor version must
+ * be the same or newer.
+ */
+static inline bool kernel_compatible()
+{
+  u16 resident = kernel_version();
+  u16 linked   = kernel_version_linked();
+
+  return (resident >> 8) == (linked >> 8) && (u8) resident >= (u8) linked;
+}
+
+#endif
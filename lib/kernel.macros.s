@@ -0,0 +1,75 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file kernel.macros.s
+ * @brief Versioned service table for a resident kernel (IPX/SPX)
+ *
+ * @details
+ * Modules normally link against the kernel through all of its symbols (-R), so
+ * any change to the kernel moves its functions and breaks modules which were
+ * built before it. Instead, a kernel can export its services through a table
+ * of jumps at a fixed address. Modules are then linked against the table
+ * entries (see tools/kernel_table.sh), which do not move as long as the table
+ * is only ever added to.
+ *
+ * The table is:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0      | word | Version (major in the upper byte, minor in the lower)
+ * 2      | word | Number of entries
+ * 4      | ...  | Entries, each a 6 byte jmp to the service
+ *
+ * Increase the minor version when adding entries to the end, and the major
+ * version when changing or removing existing entries. For example:
+ *
+ *   KERNEL_TABLE_BEGIN 0x0100
+ *   KERNEL_EXPORT init_particles
+ *   KERNEL_EXPORT process_particles
+ *   KERNEL_TABLE_END
+ *
+ * The table goes in the .ktable section, which is placed at
+ * KERNEL_TABLE_ORIGIN by the module linker script. Set this in the kernel
+ * layout after the end of the .init section.
+ */
+
+#ifndef MEGADEV__KERNEL_MACROS_S
+#define MEGADEV__KERNEL_MACROS_S
+
+/**
+ * @fn KERNEL_TABLE_BEGIN
+ * @brief Start the kernel service table
+ * @param version Table version
+ */
+.macro KERNEL_TABLE_BEGIN version
+  .section .ktable, "ax"
+  .global kernel_table
+  .global kernel_table_version
+  .equ kernel_table_version, \version
+kernel_table:
+  .word \version
+  .word (kernel_table_end - kernel_table - 4) / 6
+.endm
+
+/**
+ * @fn KERNEL_EXPORT
+ * @brief Add a service to the kernel service table
+ * @param name Symbol of the service
+ */
+.macro KERNEL_EXPORT name
+  .global kernel_table_\name
+kernel_table_\name:
+  .word 0x4EF9  // jmp (xxx).l, so that each entry is always 6 bytes
+  .long \name
+.endm
+
+/**
+ * @fn KERNEL_TABLE_END
+ * @brief End the kernel service table
+ */
+.macro KERNEL_TABLE_END
+kernel_table_end:
+  .section .text
+.endm
+
+#endif
@@ -22,5 +22,5 @@ static inline void dcmp_kosinski(void * src, void * dst)
 		"
 		: "+a"(A0), "+a"(A1)
 		: "i"(Kos_Decomp), "a"(A0), "a"(A1)
-		: "d2", "d3", "d4", "d5", "d6", "cc");
+		: "d0", "d1", "d2", "d3", "d4", "d5", "d6", "cc", "memory");
 };
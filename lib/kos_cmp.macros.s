@@ -0,0 +1,101 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file kos_cmp.macros.s
+ * @brief Decompression routine for "Kosinski" compressed data, as a macro
+ *
+ * @note Taken from Wonder Library code
+ */
+
+#ifndef MEGADEV__KOS_CMP_MACROS_S
+#define MEGADEV__KOS_CMP_MACROS_S
+
+/**
+ * @fn KOS_DECOMP
+ * @brief Decompress Kosinski data
+ * @param[in] A0.l Pointer to compressed data
+ * @param[in] A1.l Pointer to destination
+ * @param[out] A0.l Pointer to the end of the compressed data
+ * @param[out] A1.l Pointer to the end of the decompressed data
+ * @clobber d0-d6
+ * @details Uses only relative branches, so it can be expanded in code which
+ * runs before it has been copied to its linked address. Local labels 20 to 29
+ * are used.
+ */
+.macro KOS_DECOMP
+  subq.l   #2, sp       /* make space for two bytes on the stack */
+  move.b   (a0)+, 1(sp)
+  move.b   (a0)+, (sp)
+  move.w   (sp), d5     /* copy first description field */
+  moveq    #15, d4      /* 16 bits in a byte */
+
+20:lsr.w   #1, d5       /* bit which is shifted out goes into C flag */
+  move     sr, d6
+  dbra     d4, 21f
+  move.b   (a0)+, 1(sp)
+  move.b   (a0)+, (sp)
+  move.w   (sp), d5     /* get next description field if needed */
+  moveq    #15, d4      /* reset bit counter */
+
+21:move    d6, ccr      /* was the bit set? */
+  bcc.b    22f          /* if not, branch (C flag clear means bit was clear) */
+  move.b   (a0)+, (a1)+ /* otherwise, copy byte as-is */
+  bra.b    20b
+
+22:moveq   #0, d3
+  lsr.w    #1, d5       /* get next bit */
+  move     sr, d6
+  dbra     d4, 23f
+  move.b   (a0)+, 1(sp)
+  move.b   (a0)+, (sp)
+  move.w   (sp), d5
+  moveq    #15, d4
+
+23:move    d6, ccr      /* was the bit set? */
+  bcs.b    26f          /* if it was, branch */
+  lsr.w    #1, d5       /* bit which is shifted out goes into X flag */
+  dbra     d4, 24f
+  move.b   (a0)+, 1(sp)
+  move.b   (a0)+, (sp)
+  move.w   (sp), d5
+  moveq    #15, d4
+24:roxl.w  #1, d3       /* get high repeat count bit (shift X flag in) */
+  lsr.w    #1, d5
+  dbra     d4, 25f
+  move.b   (a0)+, 1(sp)
+  move.b   (a0)+, (sp)
+  move.w   (sp), d5
+  moveq    #15, d4
+25:roxl.w  #1, d3       /* get low repeat count bit */
+  addq.w   #1, d3       /* increment repeat count */
+  moveq    #-1, d2
+  move.b   (a0)+, d2    /* calculate offset */
+  bra.b    27f
+
+26:move.b  (a0)+, d0    /* get first byte */
+  move.b   (a0)+, d1    /* get second byte */
+  moveq    #-1, d2
+  move.b   d1, d2
+  lsl.w    #5, d2
+  move.b   d0, d2       /* calculate offset */
+  andi.w   #7, d1       /* does a third byte need to be read? */
+  beq.b    28f          /* if it does, branch */
+  move.b   d1, d3       /* copy repeat count */
+  addq.w   #1, d3       /* and increment it */
+
+27:move.b  (a1,d2.w), d0
+  move.b   d0, (a1)+    /* copy appropriate byte */
+  dbra     d3, 27b      /* and repeat the copying */
+  bra.b    20b
+
+28:move.b  (a0)+, d1
+  beq.b    29f          /* 0 indicates end of compressed data */
+  cmpi.b   #1, d1
+  beq.w    20b          /* 1 indicates a new description needs to be read */
+  move.b   d1, d3       /* otherwise, copy repeat count */
+  bra.b    27b
+
+29:addq.l  #2, sp       /* restore stack pointer to original state */
+.endm
+
+#endif
@@ -1489,6 +1489,7 @@ typedef struct DmaTransfer
  * The list should be terminated with a 0 word. Note that this system is
  * extremely basic and does not account for DMA bandwidth, etc. Moreover, no
  * array management is done and the list will need to be cleared by the user.
+ * See main/dmaq.h for a queue which does.
  */
 static inline void bios_dma_queue(DmaTransfer const * queue)
 {
@@ -0,0 +1,138 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/cmdq.h
+ * @brief Batched command queue to the Sub CPU (Main CPU side)
+ *
+ * @details
+ * Sending each small request (a PCM trigger, a graphics job) with a register
+ * handshake costs a full round trip with the Sub CPU per request. Instead,
+ * commands can be appended to a buffer in Word RAM over the course of a frame
+ * and sent all at once with a single doorbell. The Sub CPU then works through
+ * the whole batch in one go (see sub/cmdq.h).
+ *
+ * The buffer is in 2M Word RAM, so it must be owned by the Main CPU while
+ * commands are being added. A typical frame looks like:
+ *
+ *   if (cmdq_done() && wram_try_acquire_c())
+ *   {
+ *     cmdq_begin(&queue);
+ *     // ... cmdq_push_c() as needed ...
+ *     cmdq_ring();
+ *     wram_release_c();
+ *   }
+ *
+ * The doorbell uses a single bit of the comm flags (see cmdq.def.h), so the
+ * command and status registers remain free for other use.
+ *
+ * Be sure to include cmdq_main.s in your module when using these.
+ */
+
+#ifndef MEGADEV__MAIN_CMDQ_H
+#define MEGADEV__MAIN_CMDQ_H
+
+#include "cmdq.def.h"
+#include "main/gate_arr.h"
+#include "types.h"
+
+/**
+ * @struct CmdQueue
+ * @brief Command queue state
+ */
+typedef struct CmdQueue
+{
+  u16 * buffer;
+  u16 * write;
+  u16 * end;
+} CmdQueue;
+
+/**
+ * @fn cmdq_init
+ * @brief Set up a command queue over a buffer in Word RAM
+ * @param buffer Pointer to the buffer (which must be word aligned)
+ * @param size Size of the buffer in bytes
+ */
+static inline void cmdq_init(CmdQueue * queue, void * buffer, u16 size)
+{
+  queue->buffer = (u16 *) buffer;
+  queue->write = (u16 *) buffer + 1;
+  queue->end = (u16 *) ((u8 *) buffer + size);
+}
+
+/**
+ * @fn cmdq_begin
+ * @brief Start a new batch
+ * @note Word RAM must be owned by the Main CPU
+ */
+static inline void cmdq_begin(CmdQueue * queue)
+{
+  *queue->buffer = 0;
+  queue->write = queue->buffer + 1;
+}
+
+/**
+ * @fn cmdq_push_c
+ * @brief Append a command to the current batch
+ * @param command Command ID (the index into the Sub CPU dispatch table)
+ * @param params Pointer to the parameter words
+ * @param count Number of parameter words (0 to CMDQ_MAX_PARAMS)
+ * @return false if there was not enough space left in the buffer
+ * @note Word RAM must be owned by the Main CPU
+ */
+static inline bool
+cmdq_push_c(CmdQueue * queue, u8 command, u16 const * params, u8 count)
+{
+  register u32 a0_queue asm("a0") = (u32) queue;
+  register u32 a1_params asm("a1") = (u32) params;
+  register u16 d0_command asm("d0") = command;
+  register u16 d1_count asm("d1") = count;
+  register u8  result;
+
+  asm volatile(
+    "\
+  jsr cmdq_push \n\
+  scc %[result] \n\
+		"
+    : [result] "=d"(result), "+a"(a1_params), "+d"(d0_command), "+d"(d1_count)
+    : "a"(a0_queue)
+    : "cc", "memory");
+
+  return result;
+}
+
+/**
+ * @fn cmdq_count
+ * @brief Number of commands in the current batch
+ */
+static inline u16 cmdq_count(CmdQueue const * queue)
+{
+  return *queue->buffer;
+}
+
+/**
+ * @fn cmdq_ring
+ * @brief Signal the Sub CPU that a new batch is ready
+ * @note Word RAM should be released to the Sub CPU afterward
+ */
+static inline void cmdq_ring()
+{
+  asm volatile(
+    "\
+  bchg #%c[bit], %c[flags] \n\
+		"
+    :
+    : [bit] "i"(CMDQ_FLAG_BIT), [flags] "i"(GA_REG_COMFLAGS)
+    : "cc", "memory");
+}
+
+/**
+ * @fn cmdq_done
+ * @brief Check if the Sub CPU has finished with the last batch
+ */
+static inline bool cmdq_done()
+{
+  return ((*ga_reg_comflags_main ^ *ga_reg_comflags_sub) & CMDQ_FLAG_MASK) ==
+         0;
+}
+
+#endif
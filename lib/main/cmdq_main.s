@@ -0,0 +1,60 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/cmdq_main.s
+ * @brief Batched command queue to the Sub CPU (Main CPU side)
+ *
+ * @details
+ * See cmdq.def.h for the buffer layout and main/cmdq.h for usage.
+ */
+
+#ifndef MEGADEV__MAIN_CMDQ_S
+#define MEGADEV__MAIN_CMDQ_S
+
+#include <macros.s>
+#include <cmdq.def.h>
+
+.section .text
+
+/**
+ * @fn cmdq_push
+ * @brief Append a command to the current batch
+ * @param[in] A0.l Pointer to CmdQueue
+ * @param[in] A1.l Pointer to parameters
+ * @param[in] D0.b Command ID
+ * @param[in] D1.w Number of parameter words (0 to 255)
+ * @param[out] CC Command added
+ * @param[out] CS Not enough space left in the buffer
+ * @clobber d0-d1/a1
+ */
+SUB cmdq_push
+  PUSHM    d2/a2
+  movea.l  4(a0), a2     // write pointer
+  // header word plus parameters
+  moveq    #0, d2
+  move.w   d1, d2
+  addq.w   #1, d2
+  add.w    d2, d2
+  add.l    a2, d2
+  cmp.l    8(a0), d2
+  bhi      9f
+
+  lsl.w    #8, d0
+  move.b   d1, d0
+  move.w   d0, (a2)+
+  bra      1f
+0:move.w   (a1)+, (a2)+
+1:dbf      d1, 0b
+
+  move.l   a2, 4(a0)
+  movea.l  (a0), a2
+  addq.w   #1, (a2)      // command count in the buffer header
+  POPM     d2/a2
+  move     #0, ccr
+  rts
+
+9:POPM     d2/a2
+  move     #1, ccr
+  rts
+
+#endif
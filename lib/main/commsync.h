@@ -0,0 +1,124 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/commsync.h
+ * @brief Per-frame mirroring of the Gate Array comm registers (Main CPU side)
+ *
+ * @details
+ * Rather than reading and writing the live comm registers throughout the
+ * frame, the program works with two arrays in Main RAM: @ref comm_cmd, which
+ * is sent to the COMCMD registers, and @ref comm_stat, a snapshot of the
+ * COMSTAT registers as last written by the Sub CPU. @ref comm_sync_c copies
+ * both as a block, so all eight words in each direction always come from the
+ * same update.
+ *
+ * Nothing calls the sync automatically: the program must call
+ * @ref comm_sync_c once per frame from its VBlank handler, with the Sub CPU
+ * calling its counterpart from sp_int2 (see sub/commsync.h). With the Boot
+ * ROM VBlank handler, that is the routine in @ref bios_vblank_user:
+ *
+ *   void vblank_user()
+ *   {
+ *     comm_sync_c();
+ *     ...
+ *   }
+ *
+ *   // at startup, before enabling interrupts
+ *   comm_sync_reset_c();
+ *   *bios_vblank_user = vblank_user;
+ *   bios_vblank_handler_flags |= BIOS_MASK_DO_USERCALL;
+ *
+ * A new snapshot then arrives every frame, one frame after it was written.
+ * Use @ref comm_lock and @ref comm_unlock around code that must read or
+ * write several words of the mirrors together.
+ *
+ * The sync writes all of the COMCMD registers each time it sends, so it
+ * cannot be mixed with code which uses the live registers, such as the
+ * command handshake in the example kernels.
+ *
+ * See commsync.def.h for the flag semantics.
+ *
+ * Be sure to include commsync_main.s in your module when using these.
+ */
+
+#ifndef MEGADEV__MAIN_COMMSYNC_H
+#define MEGADEV__MAIN_COMMSYNC_H
+
+#include "commsync.def.h"
+#include "types.h"
+
+/**
+ * @var comm_cmd
+ * @brief Values to be sent to COMCMD0-7
+ */
+extern volatile u16 comm_cmd[COMMSYNC_WORDS];
+
+/**
+ * @var comm_stat
+ * @brief Snapshot of COMSTAT0-7
+ */
+extern volatile u16 const comm_stat[COMMSYNC_WORDS];
+
+/**
+ * @var comm_sync_count
+ * @brief Incremented each time a new snapshot is received
+ */
+extern volatile u16 comm_sync_count;
+
+/**
+ * @var comm_hold
+ * @brief The mirrors are not synced while this is non-zero
+ */
+extern volatile u8 comm_hold;
+
+/**
+ * @fn comm_sync_reset_c
+ * @brief Clear the mirrors and the Main side sync flags
+ * @note Both CPUs should reset before the sync is started
+ */
+static inline void comm_sync_reset_c()
+{
+  asm volatile(
+    "\
+  jsr comm_sync_reset \n\
+		"
+    :
+    :
+    : "d0", "a0", "cc", "memory");
+}
+
+/**
+ * @fn comm_sync_c
+ * @brief Exchange the mirrors with the comm registers
+ * @note Call this once per frame from the VBlank handler
+ */
+static inline void comm_sync_c()
+{
+  asm volatile(
+    "\
+  jsr comm_sync \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+/**
+ * @fn comm_lock
+ * @brief Prevent the mirrors from being synced
+ */
+static inline void comm_lock()
+{
+  ++comm_hold;
+}
+
+/**
+ * @fn comm_unlock
+ * @brief Allow the mirrors to be synced again
+ */
+static inline void comm_unlock()
+{
+  --comm_hold;
+}
+
+#endif
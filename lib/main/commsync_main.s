@@ -0,0 +1,98 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/commsync_main.s
+ * @brief Gate Array comm register sync (Main CPU side)
+ *
+ * @details
+ * See commsync.def.h for the flag semantics and main/commsync.h for usage.
+ */
+
+#ifndef MEGADEV__MAIN_COMMSYNC_S
+#define MEGADEV__MAIN_COMMSYNC_S
+
+#include <macros.s>
+#include <commsync.def.h>
+#include <main/gate_arr.def.h>
+
+.section .text
+
+/**
+ * @fn comm_sync_reset
+ * @brief Clear the mirrors and the Main side sync flags
+ * @clobber d0/a0
+ * @note Both CPUs should reset before the sync is started
+ */
+SUB comm_sync_reset
+  lea      comm_cmd, a0
+  moveq    #(COMMSYNC_WORDS * 2 * 2 / 4) - 1, d0
+0:clr.l    (a0)+
+  dbf      d0, 0b
+  clr.w    comm_sync_count
+  sf       comm_hold
+  andi.b   #~(COMMSYNC_SEND_MASK | COMMSYNC_ACK_MASK), GA_REG_COMFLAGS
+  rts
+
+/**
+ * @fn comm_sync
+ * @brief Exchange the comm register mirrors with the hardware
+ * @clobber d0-d1/a0-a1
+ * @details Copies a new block of COMSTAT registers from the Sub CPU into
+ * comm_stat, if there is one, then writes comm_cmd to the COMCMD registers if
+ * the Sub CPU has taken the previous block. Nothing is done while comm_hold is
+ * non-zero.
+ * @note Call this once per frame from the VBlank handler
+ */
+SUB comm_sync
+  tst.b    comm_hold
+  bne      9f
+
+  // incoming: Sub SEND against our ACK
+  btst     #COMMSYNC_SEND_BIT, GA_REG_COMFLAGS+1
+  sne      d0
+  btst     #COMMSYNC_ACK_BIT, GA_REG_COMFLAGS
+  sne      d1
+  cmp.b    d0, d1
+  beq      2f
+  lea      GA_REG_COMSTAT0, a0
+  lea      comm_stat, a1
+  move.l   (a0)+, (a1)+
+  move.l   (a0)+, (a1)+
+  move.l   (a0)+, (a1)+
+  move.l   (a0)+, (a1)+
+  bchg     #COMMSYNC_ACK_BIT, GA_REG_COMFLAGS
+  addq.w   #1, comm_sync_count
+
+  // outgoing: our SEND against Sub ACK
+2:btst     #COMMSYNC_SEND_BIT, GA_REG_COMFLAGS
+  sne      d0
+  btst     #COMMSYNC_ACK_BIT, GA_REG_COMFLAGS+1
+  sne      d1
+  cmp.b    d0, d1
+  bne      9f           // previous block not yet taken
+  lea      comm_cmd, a0
+  lea      GA_REG_COMCMD0, a1
+  move.l   (a0)+, (a1)+
+  move.l   (a0)+, (a1)+
+  move.l   (a0)+, (a1)+
+  move.l   (a0)+, (a1)+
+  bchg     #COMMSYNC_SEND_BIT, GA_REG_COMFLAGS
+9:rts
+
+.section .bss
+
+.global comm_cmd
+comm_cmd: .space COMMSYNC_WORDS * 2
+
+.global comm_stat
+comm_stat: .space COMMSYNC_WORDS * 2
+
+.global comm_sync_count
+comm_sync_count: .word 0
+
+.global comm_hold
+comm_hold: .byte 0
+
+.align 2
+
+#endif
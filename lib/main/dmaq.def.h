@@ -0,0 +1,86 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/dmaq.def.h
+ * @brief VBlank DMA queue definitions
+ *
+ * @details
+ * Each queued transfer is an entry in this format:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | long | Source address
+ * 0x04   | long | Destination (vdp_cmd, e.g. VRAM_W, CRAM_W or VSRAM_W)
+ * 0x08   | word | Length (in words)
+ * 0x0A   | byte | Flags
+ * 0x0B   | byte | Priority
+ * 0x0C   | byte | VDP auto increment
+ * 0x0D   | byte | (unused)
+ *
+ * Entries are kept in order of priority, with 0 sent first. Entries with the
+ * same priority are sent in the order they were queued.
+ */
+
+#ifndef MEGADEV__MAIN_DMAQ_DEF_H
+#define MEGADEV__MAIN_DMAQ_DEF_H
+
+#define DMAQ_SOURCE   0x00
+#define DMAQ_DEST     0x04
+#define DMAQ_LENGTH   0x08
+#define DMAQ_FLAGS    0x0A
+#define DMAQ_PRIORITY 0x0B
+#define DMAQ_AUTOINC  0x0C
+
+/**
+ * @def DMAQ_ENTRY_SIZE
+ * @brief Size of a queue entry in bytes
+ */
+#define DMAQ_ENTRY_SIZE 14
+
+/**
+ * @def DMAQ_SIZE
+ * @brief Number of entries in the queue
+ * @details A transfer which crosses a 128KB boundary takes two entries.
+ */
+#ifndef DMAQ_SIZE
+#define DMAQ_SIZE 32
+#endif
+
+/**
+ * @def DMAQ_BIT_WHOLE
+ * @brief The transfer is never split across frames
+ * @details Without this flag, a transfer which does not fit in what is left
+ * of the budget is partly sent and the rest is deferred to the next frame.
+ * Set it for data which must arrive at once, such as the sprite table. Such
+ * a transfer must fit within the budget.
+ */
+#define DMAQ_BIT_WHOLE 0
+#define DMAQ_FLAG_WHOLE (1 << DMAQ_BIT_WHOLE)
+
+/**
+ * @def DMAQ_BYTES_H40
+ * @brief Bytes transferred per line during VBlank in H40 (320 pixel) mode
+ */
+#define DMAQ_BYTES_H40 205
+
+/**
+ * @def DMAQ_BYTES_H32
+ * @brief Bytes transferred per line during VBlank in H32 (256 pixel) mode
+ */
+#define DMAQ_BYTES_H32 167
+
+/**
+ * @def DMAQ_LINE_MARGIN
+ * @brief VBlank lines not counted in the budget
+ * @details Covers the interrupt response and the VBlank handler work before
+ * the queue is flushed.
+ */
+#ifndef DMAQ_LINE_MARGIN
+#define DMAQ_LINE_MARGIN 3
+#endif
+
+#define DMAQ_LINES_NTSC    (262 - 224 - DMAQ_LINE_MARGIN)
+#define DMAQ_LINES_PAL     (313 - 224 - DMAQ_LINE_MARGIN)
+#define DMAQ_LINES_PAL_V30 (313 - 240 - DMAQ_LINE_MARGIN)
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/dmaq.h
+ * @brief VBlank DMA queue
+ *
+ * @details
+ * Transfers to VRAM, CRAM and VSRAM are queued during the frame and sent
+ * from the VBlank handler, in order of priority, up to the number of bytes
+ * the VDP can take during VBlank in the current video mode. What does not fit
+ * is kept for the next frame.
+ *
+ *   dmaq_init_c(VDP_DMA_ENABLE | VDP_VBLANK_ENABLE | VDP_DISPLAY_ENABLE |
+ *                 VDP_MD_DISPLAY_MODE,
+ *               VDP_MASK_WIDTH_40CELL);
+ *
+ *   // in the main loop
+ *   dmaq_push_c(tiles, to_vdp_addr(0x2000) | VRAM_W, 0x400, 2, 0);
+ *   dmaq_push_c(sprites, to_vdp_addr(0xF800) | VRAM_W, 320, 0,
+ *               DMAQ_FLAG_WHOLE);
+ *
+ *   // in the VBlank handler
+ *   dmaq_flush_c();
+ *
+ * The source data must not change until it has been sent; dmaq_count reaches
+ * 0 once everything has been sent. dmaq_push_stride_c queues a transfer with
+ * its own VDP auto increment, e.g. to write down a nametable column.
+ *
+ * dmaq_sent, dmaq_deferred and dmaq_dropped can be used to tune the amount of
+ * data pushed each frame: a deferred count which stays above 0 means the
+ * queue is falling behind.
+ *
+ * @warning DMA from Word RAM has a hardware quirk where the first word written
+ * is invalid. Sources in Word RAM should be pushed from 2 bytes before the
+ * data, with the first word written by the CPU instead.
+ *
+ * Be sure to include dmaq_main.s and vdp.s in your module when using these.
+ */
+
+#ifndef MEGADEV__MAIN_DMAQ_H
+#define MEGADEV__MAIN_DMAQ_H
+
+#include "main/dmaq.def.h"
+#include "main/vdp.h"
+#include "types.h"
+
+/**
+ * @var dmaq_count
+ * @brief Number of entries in the queue
+ */
+extern u16 volatile dmaq_count;
+
+/**
+ * @var dmaq_budget
+ * @brief Bytes sent per flush
+ * @details Set by @ref dmaq_init_c, and may be changed afterward (e.g.
+ * while the display is disabled, when all of the frame can be used).
+ */
+extern u16 volatile dmaq_budget;
+
+/**
+ * @var dmaq_sent
+ * @brief Bytes sent in the last flush
+ */
+extern u16 volatile dmaq_sent;
+
+/**
+ * @var dmaq_deferred
+ * @brief Bytes left in the queue after the last flush
+ */
+extern u32 volatile dmaq_deferred;
+
+/**
+ * @var dmaq_dropped
+ * @brief Bytes dropped because the queue was full, since it was set up
+ */
+extern u32 volatile dmaq_dropped;
+
+/**
+ * @fn dmaq_init_c
+ * @brief Empty the queue and set the budget for the video mode
+ * @param mode2 Value of VDP Mode Register 2
+ * @param mode4 Value of VDP Mode Register 4
+ */
+static inline void dmaq_init_c(u8 mode2, u8 mode4)
+{
+  register u8 d0_mode2 asm("d0") = mode2;
+  register u8 d1_mode4 asm("d1") = mode4;
+
+  asm volatile(
+    "\
+  jsr dmaq_init \n\
+		"
+    : "+d"(d0_mode2), "+d"(d1_mode4)
+    :
+    : "cc", "memory");
+}
+
+/**
+ * @fn dmaq_push_c
+ * @brief Queue a transfer to VRAM, CRAM or VSRAM
+ * @param source Source address (must be word aligned)
+ * @param dest Destination, e.g. to_vdp_addr(0x2000) | VRAM_W
+ * @param length Length of data (in words)
+ * @param priority Priority (0 is sent first)
+ * @param flags DMAQ_FLAG_WHOLE or 0
+ * @return false if the queue was full and the transfer was dropped
+ */
+static inline bool dmaq_push_c(
+  void const * source, vdp_cmd dest, u16 length, u8 priority, u8 flags)
+{
+  register u32 d0_dest asm("d0") = dest;
+  register u32 d1_source asm("d1") = (u32) source;
+  register u16 d2_length asm("d2") = length;
+  register u16 d3_prio asm("d3") = (flags << 8) | priority;
+  register u8  result;
+
+  asm volatile(
+    "\
+  jsr dmaq_push \n\
+  scc %[result] \n\
+		"
+    : "+d"(d0_dest), "+d"(d1_source), [result] "=d"(result)
+    : "d"(d2_length), "d"(d3_prio)
+    : "a0", "a1", "cc", "memory");
+
+  return result;
+}
+
+/**
+ * @fn dmaq_push_stride_c
+ * @brief Queue a transfer with a VDP auto increment other than 2
+ * @param source Source address (must be word aligned)
+ * @param dest Destination, e.g. to_vdp_addr(0xC000) | VRAM_W
+ * @param length Length of data (in words)
+ * @param priority Priority (0 is sent first)
+ * @param flags DMAQ_FLAG_WHOLE or 0
+ * @param autoinc Bytes between each word written, e.g. 128 to go down a
+ * column of a 64 cell wide nametable
+ * @return false if the queue was full and the transfer was dropped
+ */
+static inline bool dmaq_push_stride_c(void const * source,
+  vdp_cmd dest,
+  u16 length,
+  u8 priority,
+  u8 flags,
+  u8 autoinc)
+{
+  register u32 d0_dest asm("d0") = dest;
+  register u32 d1_source asm("d1") = (u32) source;
+  register u16 d2_length asm("d2") = length;
+  register u16 d3_prio asm("d3") = (flags << 8) | priority;
+  register u8  d4_autoinc asm("d4") = autoinc;
+  register u8  result;
+
+  asm volatile(
+    "\
+  jsr dmaq_push_stride \n\
+  scc %[result] \n\
+		"
+    : "+d"(d0_dest), "+d"(d1_source), [result] "=d"(result)
+    : "d"(d2_length), "d"(d3_prio), "d"(d4_autoinc)
+    : "a0", "a1", "cc", "memory");
+
+  return result;
+}
+
+/**
+ * @fn dmaq_flush_c
+ * @brief Send queued transfers, up to the budget
+ * @note Call from the VBlank handler, with DMA enabled on the VDP
+ */
+static inline void dmaq_flush_c()
+{
+  asm volatile(
+    "\
+  jsr dmaq_flush \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+#endif
@@ -0,0 +1,320 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/dmaq_main.s
+ * @brief VBlank DMA queue
+ *
+ * @details
+ * See dmaq.def.h for the entry layout and main/dmaq.h for usage. The
+ * transfers are made with VDP_DMA_TRANSFER, so vdp.s must be included in the
+ * module as well.
+ */
+
+#ifndef MEGADEV__MAIN_DMAQ_S
+#define MEGADEV__MAIN_DMAQ_S
+
+#include <macros.s>
+#include <main/dmaq.def.h>
+#include <main/vdp.def.h>
+
+.section .text
+
+/**
+ * @fn dmaq_init
+ * @brief Empty the queue and set the budget for the video mode
+ * @param[in] D0.b Value of VDP Mode Register 2
+ * @param[in] D1.b Value of VDP Mode Register 4
+ * @clobber d0-d1
+ * @details The budget is the number of bytes which can be sent during VBlank
+ * in the given mode, on NTSC or PAL hardware as reported by the VDP. It can
+ * be changed afterward with dmaq_budget, e.g. while the display is disabled.
+ * The dropped count is reset.
+ */
+SUB dmaq_init
+  move.l   #dmaq_queue, dmaq_end
+  clr.w    dmaq_count
+  clr.w    dmaq_sent
+  clr.l    dmaq_deferred
+  clr.l    dmaq_dropped
+
+  // VBlank lines
+  btst     #0, (VDP_CTRL + 1).l       // VDPSTAT_MASK_PAL_HARDWARE
+  beq      2f
+  andi.b   #VDP_PAL_VIDEO, d0
+  beq      1f
+  move.w   #DMAQ_LINES_PAL_V30, d0
+  bra      3f
+1:move.w   #DMAQ_LINES_PAL, d0
+  bra      3f
+2:move.w   #DMAQ_LINES_NTSC, d0
+
+  // bytes per line
+3:andi.b   #VDP_MASK_WIDTH_40CELL, d1
+  beq      4f
+  move.w   #DMAQ_BYTES_H40, d1
+  bra      5f
+4:move.w   #DMAQ_BYTES_H32, d1
+5:mulu.w   d1, d0
+  move.w   d0, dmaq_budget
+  rts
+
+/**
+ * @fn dmaq_push
+ * @brief Queue a transfer to VRAM, CRAM or VSRAM
+ * @param[in] D0.l Destination address (in vdp_cmd format)
+ * @param[in] D1.l Source address
+ * @param[in] D2.w Length of data (in words)
+ * @param[in] D3.w Flags (upper byte) and priority (lower byte)
+ * @param[out] CC Transfer queued
+ * @param[out] CS Queue is full; the transfer was dropped
+ * @clobber d0-d1/a0-a1
+ * @details A transfer which crosses a 128KB boundary in the source is split
+ * in two entries, as the VDP source address wraps within each 128KB. Either
+ * both are queued or neither. Interrupts are masked while the queue is
+ * changed.
+ */
+SUB dmaq_push
+  PUSHM    d2-d6
+  moveq    #2, d6
+  bra      0f
+
+/**
+ * @fn dmaq_push_stride
+ * @brief Queue a transfer with a VDP auto increment other than 2
+ * @param[in] D0.l Destination address (in vdp_cmd format)
+ * @param[in] D1.l Source address
+ * @param[in] D2.w Length of data (in words)
+ * @param[in] D3.w Flags (upper byte) and priority (lower byte)
+ * @param[in] D4.b VDP auto increment
+ * @param[out] CC Transfer queued
+ * @param[out] CS Queue is full; the transfer was dropped
+ * @clobber d0-d1/a0-a1
+ * @details As dmaq_push. The source is still read a word at a time, while
+ * each word is written the given number of bytes after the previous one, e.g.
+ * down a column of a nametable.
+ */
+SUB dmaq_push_stride
+  PUSHM    d2-d6
+  moveq    #0, d6
+  move.b   d4, d6
+
+0:move     sr, -(sp)
+  ori      #0x700, sr
+  tst.w    d2
+  beq      8f
+
+  // words left before the next 128KB boundary, where 0 is a full 64K
+  move.l   d1, d4
+  lsr.l    #1, d4
+  neg.w    d4
+  beq      1f
+  cmp.w    d4, d2
+  bls      1f
+
+  cmpi.w   #DMAQ_SIZE - 1, dmaq_count
+  bcc      9f
+  move.w   d2, d5
+  sub.w    d4, d5                  // second part
+  move.w   d4, d2                  // first part
+  bsr      10f
+  move.w   d6, d4
+  bsr      dmaq_advance
+  move.w   d5, d2
+  bsr      10f
+  bra      8f
+
+1:cmpi.w   #DMAQ_SIZE, dmaq_count
+  bcc      9f
+  bsr      10f
+
+8:move     (sp)+, sr
+  POPM     d2-d6
+  move     #0, ccr
+  rts
+
+9:moveq    #0, d4
+  move.w   d2, d4
+  add.l    d4, d4
+  add.l    d4, dmaq_dropped
+  move     (sp)+, sr
+  POPM     d2-d6
+  move     #1, ccr
+  rts
+
+  // insert the entry in d0-d3/d6 after the last entry of the same or a lower
+  // priority
+10:movea.l dmaq_end, a0
+11:cmpa.l  #dmaq_queue, a0
+  beq      12f
+  cmp.b    (DMAQ_PRIORITY - DMAQ_ENTRY_SIZE, a0), d3
+  bcc      12f
+  lea      -DMAQ_ENTRY_SIZE(a0), a1
+  move.l   (a1), (a0)
+  move.l   4(a1), 4(a0)
+  move.l   8(a1), 8(a0)
+  move.w   12(a1), 12(a0)
+  movea.l  a1, a0
+  bra      11b
+12:move.l  d1, DMAQ_SOURCE(a0)
+  move.l   d0, DMAQ_DEST(a0)
+  move.w   d2, DMAQ_LENGTH(a0)
+  move.w   d3, DMAQ_FLAGS(a0)
+  move.b   d6, DMAQ_AUTOINC(a0)
+  addi.l   #DMAQ_ENTRY_SIZE, dmaq_end
+  addq.w   #1, dmaq_count
+  rts
+
+/**
+ * @brief Move a transfer forward
+ * @param[in] D0.l Destination address (in vdp_cmd format)
+ * @param[in] D1.l Source address
+ * @param[in] D2.w Number of words to move forward
+ * @param[in] D4.w VDP auto increment
+ * @param[out] D0.l Updated destination
+ * @param[out] D1.l Updated source
+ */
+dmaq_advance:
+  PUSHM    d2-d3/d5
+  andi.l   #0xFFFF, d2
+  move.w   d2, d5
+  mulu.w   d4, d5                  // bytes written
+  add.l    d2, d2
+  add.l    d2, d1
+
+  // destination as a 16 bit address
+  move.l   d0, d3
+  swap     d3
+  andi.w   #0x3FFF, d3
+  moveq    #3, d2
+  and.w    d0, d2
+  ror.w    #2, d2
+  or.w     d2, d3
+  add.w    d5, d3
+
+  // and back, keeping the operation bits
+  andi.l   #0xC00000F0, d0
+  moveq    #0, d2
+  move.w   d3, d2
+  lsl.l    #2, d2
+  lsr.w    #2, d2
+  swap     d2
+  or.l     d2, d0
+  POPM     d2-d3/d5
+  rts
+
+/**
+ * @fn dmaq_flush
+ * @brief Send queued transfers, up to the budget
+ * @clobber d0-d1/a0-a1
+ * @details Meant to be called from the VBlank handler, before any other VDP
+ * work. Transfers are sent in order of priority. When one does not fit in
+ * what is left of the budget, as much of it as fits is sent and the rest is
+ * kept for the next frame, unless it has DMAQ_FLAG_WHOLE, in which case all
+ * of it is kept and the transfers after it are still tried.
+ *
+ * The VDP auto increment is left at 2.
+ * @warning Enabling/disabling the DMA Enable bit on VDP Mode Register 2 is the
+ * responsibility of the user
+ */
+SUB dmaq_flush
+  PUSHM    d2-d7/a2-a3/a6
+  moveq    #0, d7
+  move.w   dmaq_budget, d7
+  lsr.w    #1, d7                  // words left in the budget
+  moveq    #0, d6                  // words sent
+  moveq    #0, d5                  // words deferred
+  lea      dmaq_queue, a2          // next entry
+  movea.l  a2, a3                  // where to keep deferred entries
+  move.l   dmaq_end, d4
+  bra      8f
+
+1:moveq    #0, d2
+  move.w   DMAQ_LENGTH(a2), d2
+  tst.w    d7
+  beq      5f
+  move.w   #VDP_REG_AUTOINC, d0
+  move.b   DMAQ_AUTOINC(a2), d0
+  move.w   d0, (VDP_CTRL).l
+  cmp.w    d7, d2
+  bls      3f
+  btst     #DMAQ_BIT_WHOLE, DMAQ_FLAGS(a2)
+  bne      5f
+
+  // send what fits, keep the rest
+  move.l   DMAQ_DEST(a2), d0
+  move.l   DMAQ_SOURCE(a2), d1
+  move.w   d7, d2
+  jsr      VDP_DMA_TRANSFER
+  move.l   d4, -(sp)
+  moveq    #0, d4
+  move.b   DMAQ_AUTOINC(a2), d4
+  move.l   DMAQ_DEST(a2), d0
+  move.l   DMAQ_SOURCE(a2), d1
+  move.w   d7, d2
+  bsr      dmaq_advance
+  move.l   (sp)+, d4
+  move.l   d0, DMAQ_DEST(a2)
+  move.l   d1, DMAQ_SOURCE(a2)
+  sub.w    d7, DMAQ_LENGTH(a2)
+  add.l    d7, d6
+  moveq    #0, d7
+  move.w   DMAQ_LENGTH(a2), d2
+  bra      5f
+
+3:sub.w    d2, d7
+  add.l    d2, d6
+  move.l   DMAQ_DEST(a2), d0
+  move.l   DMAQ_SOURCE(a2), d1
+  jsr      VDP_DMA_TRANSFER
+  lea      DMAQ_ENTRY_SIZE(a2), a2
+  bra      8f
+
+  // keep for the next frame
+5:add.l    d2, d5
+  move.l   (a2)+, (a3)+
+  move.l   (a2)+, (a3)+
+  move.l   (a2)+, (a3)+
+  move.w   (a2)+, (a3)+
+
+8:cmpa.l   d4, a2
+  bcs      1b
+
+  move.w   #VDP_REG_AUTOINC | 2, (VDP_CTRL).l
+  move.l   a3, dmaq_end
+  move.l   a3, d0
+  subi.l   #dmaq_queue, d0
+  divu.w   #DMAQ_ENTRY_SIZE, d0
+  move.w   d0, dmaq_count
+  add.l    d6, d6
+  move.w   d6, dmaq_sent
+  add.l    d5, d5
+  move.l   d5, dmaq_deferred
+  POPM     d2-d7/a2-a3/a6
+  rts
+
+.section .bss
+
+.global dmaq_queue
+dmaq_queue: .space DMAQ_SIZE * DMAQ_ENTRY_SIZE
+
+.global dmaq_end
+dmaq_end: .long 0
+
+.global dmaq_count
+dmaq_count: .word 0
+
+.global dmaq_budget
+dmaq_budget: .word 0
+
+.global dmaq_sent
+dmaq_sent: .word 0
+
+.align 2
+
+.global dmaq_deferred
+dmaq_deferred: .long 0
+
+.global dmaq_dropped
+dmaq_dropped: .long 0
+
+#endif
@@ -161,6 +161,8 @@ typedef u16 volatile * ga_reg;
 /**
  * @fn wait_2m
  * Wait for Main CPU access to 2M Word RAM
+ * @sa wram_acquire_c for a version with a timeout, and main/wordram.h for
+ * non-blocking ownership handling
  */
 static inline void wait_2m()
 {
@@ -177,6 +179,7 @@ static inline void wait_2m()
 /**
  * @fn grant_2m
  * Grant 2M Word RAM access to the Sub CPU and wait for confirmation
+ * @sa wram_release_c
  */
 static inline void grant_2m()
 {
@@ -0,0 +1,98 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/map.def.h
+ * @brief Scrolling map definitions
+ *
+ * @details
+ * A map is made of 16x16 pixel metatiles. The map data is one byte per
+ * metatile, row by row, and each metatile is four nametable entries (top
+ * left, top right, bottom left, bottom right) in the metatile table.
+ *
+ * The map state is a structure in RAM, set up by the user up to MAP_ATTR and
+ * by map_init from there:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | long | Pointer to the metatile table
+ * 0x04   | long | Pointer to the map data
+ * 0x08   | word | Map width (in metatiles)
+ * 0x0A   | word | Map height (in metatiles)
+ * 0x0C   | word | VRAM address of the plane nametable
+ * 0x0E   | word | Plane width (in cells, 32 or 64)
+ * 0x10   | word | Plane height (in cells)
+ * 0x12   | word | Added to every nametable entry (palette, priority and
+ *                 first tile)
+ * 0x14   | word | Camera X
+ * 0x16   | word | Camera Y
+ * 0x18   | word | First cell column in the plane
+ * 0x1A   | word | First cell row in the plane
+ * 0x1C   | word | Number of cell columns kept in the plane
+ * 0x1E   | word | Number of cell rows kept in the plane
+ * 0x20   | word | Largest camera X
+ * 0x22   | word | Largest camera Y
+ * 0x24   | word | Screen width (in pixels)
+ * 0x26   | word | Screen height (in pixels)
+ * 0x28   | long | Next free word in the strip buffer
+ * 0x2C   | long | Start of the strip buffer half in use
+ * 0x30   |      | Strip buffer (two halves of MAP_HALF_SIZE bytes)
+ */
+
+#ifndef MEGADEV__MAIN_MAP_DEF_H
+#define MEGADEV__MAIN_MAP_DEF_H
+
+#define MAP_METATILES  0x00
+#define MAP_DATA       0x04
+#define MAP_WIDTH      0x08
+#define MAP_HEIGHT     0x0A
+#define MAP_PLANE      0x0C
+#define MAP_PLANE_W    0x0E
+#define MAP_PLANE_H    0x10
+#define MAP_ATTR       0x12
+#define MAP_CAM_X      0x14
+#define MAP_CAM_Y      0x16
+#define MAP_LEFT       0x18
+#define MAP_TOP        0x1A
+#define MAP_COLS       0x1C
+#define MAP_ROWS       0x1E
+#define MAP_MAX_X      0x20
+#define MAP_MAX_Y      0x22
+#define MAP_VIEW_W     0x24
+#define MAP_VIEW_H     0x26
+#define MAP_BUF_PTR    0x28
+#define MAP_BUF_HALF   0x2C
+#define MAP_BUFFER     0x30
+
+/**
+ * @def MAP_STRIPS
+ * @brief Largest number of columns, and of rows, streamed per frame
+ * @details This limits the camera speed to MAP_STRIPS * 8 pixels per frame
+ * on each axis.
+ */
+#ifndef MAP_STRIPS
+#define MAP_STRIPS 2
+#endif
+
+/**
+ * @def MAP_STRIP_CELLS
+ * @brief Largest number of cells in a streamed column or row
+ */
+#define MAP_STRIP_CELLS 64
+
+#define MAP_HALF_SIZE (MAP_STRIPS * 2 * MAP_STRIP_CELLS * 2)
+
+/**
+ * @def MAP_SIZE
+ * @brief Size of the map state in bytes
+ */
+#define MAP_SIZE (MAP_BUFFER + MAP_HALF_SIZE * 2)
+
+/**
+ * @def MAP_DMA_PRIORITY
+ * @brief Priority of streamed columns and rows in the DMA queue
+ */
+#ifndef MAP_DMA_PRIORITY
+#define MAP_DMA_PRIORITY 1
+#endif
+
+#endif
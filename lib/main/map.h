@@ -0,0 +1,161 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/map.h
+ * @brief Scrolling map engine
+ *
+ * @details
+ * Keeps a camera over a map of 16x16 pixel metatiles which can be much larger
+ * than the plane. Only the cells around the screen are in the plane; as the
+ * camera moves, the newly exposed columns and rows are expanded from the
+ * metatiles and queued for DMA (see main/dmaq.h), so the VDP traffic each
+ * frame depends on how far the camera moved rather than on the size of the
+ * map.
+ *
+ *   Map level = {
+ *     .metatiles = level_metatiles,
+ *     .data = level_map,
+ *     .width = 256,
+ *     .height = 32,
+ *     .plane = BIOS_VDP_DEFAULT_PLANEA,
+ *     .plane_w = 64,
+ *     .plane_h = 32,
+ *     .attr = level_tiles};
+ *
+ *   // with the display disabled
+ *   map_init_c(&level, vdpreg_get(VDP_REG_MODE2), vdpreg_get(VDP_REG_MODE4),
+ *              0, 0);
+ *
+ *   // each frame
+ *   map_move_c(&level, player_x - 160, player_y - 112);
+ *   // then scroll the plane by -level.cam_x and level.cam_y
+ *
+ * The map data is a byte per metatile, row by row, and the metatile table is
+ * four nametable entries per metatile (top left, top right, bottom left,
+ * bottom right); attr is added to each entry, e.g. the first tile given by
+ * the VRAM allocator (see main/vram.h). The map data can be in Work RAM or in
+ * Word RAM; a compressed map is unpacked there first, e.g. with
+ * dcmp_kosinski (see kos_cmp.h).
+ *
+ * The plane must be 32 or 64 cells wide, and for smooth scrolling at least
+ * one cell wider and taller than the screen: with a plane the size of the
+ * screen, the camera moves by whole cells on that axis. The camera moves at
+ * most MAP_STRIPS * 8 pixels per frame on each axis; map_move_c holds it
+ * back if asked to move further, and the position in cam_x and cam_y is the
+ * one to scroll to.
+ *
+ * Be sure to include map_main.s, dmaq_main.s and vdp.s in your module when
+ * using these.
+ */
+
+#ifndef MEGADEV__MAIN_MAP_H
+#define MEGADEV__MAIN_MAP_H
+
+#include "main/map.def.h"
+#include "types.h"
+
+/**
+ * @struct Map
+ * @brief Scrolling map state
+ * @details Fill in the fields up to attr; the rest is set by map_init_c.
+ */
+typedef struct Map
+{
+  /**
+   * @brief Nametable entries for each metatile
+   */
+  u16 const * metatiles;
+  /**
+   * @brief Metatile indices, row by row
+   */
+  u8 const * data;
+  /**
+   * @brief Map size (in metatiles)
+   */
+  u16 width;
+  u16 height;
+  /**
+   * @brief VRAM address of the plane nametable
+   */
+  u16 plane;
+  /**
+   * @brief Plane size (in cells)
+   */
+  u16 plane_w;
+  u16 plane_h;
+  /**
+   * @brief Added to every nametable entry
+   */
+  u16 attr;
+
+  s16   cam_x;
+  s16   cam_y;
+  u16   left;
+  u16   top;
+  u16   cols;
+  u16   rows;
+  u16   max_x;
+  u16   max_y;
+  u16   view_w;
+  u16   view_h;
+  u16 * buf_ptr;
+  u16 * buf_half;
+  /**
+   * @brief Strip buffer (both halves)
+   */
+  u16   buffer[MAP_HALF_SIZE];
+} Map;
+
+/**
+ * @fn map_init_c
+ * @brief Set up a map for the video mode and draw it at the camera position
+ * @param map Map state
+ * @param mode2 Value of VDP Mode Register 2
+ * @param mode4 Value of VDP Mode Register 4
+ * @param x Camera X
+ * @param y Camera Y
+ * @note The plane is written directly, so call this with the display
+ * disabled
+ */
+static inline void map_init_c(Map * map, u8 mode2, u8 mode4, s16 x, s16 y)
+{
+  register u32 a0_map asm("a0") = (u32) map;
+  register u8  d0_mode2 asm("d0") = mode2;
+  register u8  d1_mode4 asm("d1") = mode4;
+  register s16 d2_x asm("d2") = x;
+  register s16 d3_y asm("d3") = y;
+
+  asm volatile(
+    "\
+  jsr map_init \n\
+		"
+    : "+a"(a0_map), "+d"(d0_mode2), "+d"(d1_mode4)
+    : "d"(d2_x), "d"(d3_y)
+    : "a1", "cc", "memory");
+}
+
+/**
+ * @fn map_move_c
+ * @brief Move the camera and stream the newly exposed columns and rows
+ * @param map Map state
+ * @param x Camera X
+ * @param y Camera Y
+ * @details The camera is kept within the map and to what the plane holds;
+ * the resulting position is in cam_x and cam_y.
+ */
+static inline void map_move_c(Map * map, s16 x, s16 y)
+{
+  register u32 a0_map asm("a0") = (u32) map;
+  register s16 d0_x asm("d0") = x;
+  register s16 d1_y asm("d1") = y;
+
+  asm volatile(
+    "\
+  jsr map_move \n\
+		"
+    : "+a"(a0_map), "+d"(d0_x), "+d"(d1_y)
+    :
+    : "a1", "cc", "memory");
+}
+
+#endif
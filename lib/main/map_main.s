@@ -0,0 +1,440 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/map_main.s
+ * @brief Scrolling map engine
+ *
+ * @details
+ * See map.def.h for the map format and main/map.h for usage. Columns and rows
+ * are sent through the DMA queue, so dmaq_main.s and vdp.s must be included
+ * in the module as well.
+ */
+
+#ifndef MEGADEV__MAIN_MAP_S
+#define MEGADEV__MAIN_MAP_S
+
+#include <macros.s>
+#include <main/dmaq.def.h>
+#include <main/map.def.h>
+#include <main/vdp.def.h>
+#include <main/vdp.macros.s>
+
+.section .text
+
+/**
+ * @fn map_init
+ * @brief Set up a map for the video mode and draw it at the camera position
+ * @param[in] A0.l Pointer to the map state
+ * @param[in] D0.b Value of VDP Mode Register 2
+ * @param[in] D1.b Value of VDP Mode Register 4
+ * @param[in] D2.w Camera X
+ * @param[in] D3.w Camera Y
+ * @clobber d0-d1/a1
+ * @details The plane is written directly rather than through the DMA queue,
+ * so this should be called while the display is disabled.
+ */
+SUB map_init
+  PUSHM    d2-d7/a2-a4
+
+  // screen size
+  move.w   #224, d4
+  andi.b   #VDP_PAL_VIDEO, d0
+  beq      1f
+  move.w   #240, d4
+1:move.w   #256, d5
+  andi.b   #VDP_MASK_WIDTH_40CELL, d1
+  beq      2f
+  move.w   #320, d5
+2:move.w   d5, MAP_VIEW_W(a0)
+  move.w   d4, MAP_VIEW_H(a0)
+
+  // one more cell than the screen, as far as the plane allows
+  move.w   d5, d0
+  lsr.w    #3, d0
+  addq.w   #1, d0
+  cmp.w    MAP_PLANE_W(a0), d0
+  bls      3f
+  move.w   MAP_PLANE_W(a0), d0
+3:move.w   d0, MAP_COLS(a0)
+  move.w   d4, d0
+  lsr.w    #3, d0
+  addq.w   #1, d0
+  cmp.w    MAP_PLANE_H(a0), d0
+  bls      4f
+  move.w   MAP_PLANE_H(a0), d0
+4:move.w   d0, MAP_ROWS(a0)
+
+  // camera limits
+  move.w   MAP_WIDTH(a0), d0
+  lsl.w    #4, d0
+  sub.w    d5, d0
+  bcc      5f
+  moveq    #0, d0
+5:move.w   d0, MAP_MAX_X(a0)
+  move.w   MAP_HEIGHT(a0), d0
+  lsl.w    #4, d0
+  sub.w    d4, d0
+  bcc      6f
+  moveq    #0, d0
+6:move.w   d0, MAP_MAX_Y(a0)
+
+  move.w   d2, d0
+  move.w   d3, d1
+  bsr      map_clamp
+  lsr.w    #3, d0
+  move.w   d0, MAP_LEFT(a0)
+  lsr.w    #3, d1
+  move.w   d1, MAP_TOP(a0)
+  lea      MAP_BUFFER(a0), a1
+  move.l   a1, MAP_BUF_HALF(a0)
+
+  // draw every row
+  moveq    #1, d5
+  move.w   MAP_TOP(a0), d6
+  move.w   MAP_ROWS(a0), d7
+  subq.w   #1, d7
+7:lea      MAP_BUFFER(a0), a1
+  move.l   a1, MAP_BUF_PTR(a0)
+  move.w   d6, d0
+  bsr      map_row
+  addq.w   #1, d6
+  dbf      d7, 7b
+
+  POPM     d2-d7/a2-a4
+  rts
+
+/**
+ * @fn map_move
+ * @brief Move the camera and stream the newly exposed columns and rows
+ * @param[in] A0.l Pointer to the map state
+ * @param[in] D0.w Camera X
+ * @param[in] D1.w Camera Y
+ * @param[out] D0.w Camera X, as it can be shown
+ * @param[out] D1.w Camera Y, as it can be shown
+ * @clobber a1
+ * @details The camera is kept within the map. At most MAP_STRIPS columns and
+ * MAP_STRIPS rows are queued for DMA; if the camera moves further than that,
+ * or the DMA queue is full, it is held back to what is in the plane and
+ * catches up on the following frames. The returned position is also in
+ * MAP_CAM_X and MAP_CAM_Y, and is the one to set the scroll values from.
+ */
+SUB map_move
+  PUSHM    d2-d7/a2-a4
+  bsr      map_clamp
+
+  // switch to the other half of the strip buffer, as the one used last
+  // frame may still be waiting in the DMA queue
+  lea      MAP_BUFFER(a0), a1
+  cmpa.l   MAP_BUF_HALF(a0), a1
+  bne      1f
+  lea      (MAP_BUFFER + MAP_HALF_SIZE, a0), a1
+1:move.l   a1, MAP_BUF_HALF(a0)
+  move.l   a1, MAP_BUF_PTR(a0)
+  moveq    #0, d5
+
+  // columns
+  moveq    #MAP_STRIPS - 1, d7
+10:move.w  MAP_CAM_X(a0), d6
+  lsr.w    #3, d6
+  move.w   MAP_LEFT(a0), d0
+  cmp.w    d0, d6
+  beq      20f
+  bcs      12f
+  add.w    MAP_COLS(a0), d0        // the column after the last
+  bsr      map_column
+  bcs      20f
+  addq.w   #1, MAP_LEFT(a0)
+  bra      13f
+12:subq.w  #1, d0                  // the column before the first
+  bsr      map_column
+  bcs      20f
+  subq.w   #1, MAP_LEFT(a0)
+13:dbf     d7, 10b
+
+  // rows, across the columns now in the plane
+20:moveq   #MAP_STRIPS - 1, d7
+21:move.w  MAP_CAM_Y(a0), d6
+  lsr.w    #3, d6
+  move.w   MAP_TOP(a0), d0
+  cmp.w    d0, d6
+  beq      30f
+  bcs      22f
+  add.w    MAP_ROWS(a0), d0
+  bsr      map_row
+  bcs      30f
+  addq.w   #1, MAP_TOP(a0)
+  bra      23f
+22:subq.w  #1, d0
+  bsr      map_row
+  bcs      30f
+  subq.w   #1, MAP_TOP(a0)
+23:dbf     d7, 21b
+
+  // hold the camera to what is in the plane
+30:move.w  MAP_LEFT(a0), d0
+  lsl.w    #3, d0
+  move.w   MAP_CAM_X(a0), d1
+  cmp.w    d0, d1
+  bcc      31f
+  move.w   d0, d1
+  bra      32f
+31:move.w  MAP_COLS(a0), d2
+  lsl.w    #3, d2
+  sub.w    MAP_VIEW_W(a0), d2
+  add.w    d0, d2
+  cmp.w    d2, d1
+  bls      32f
+  move.w   d2, d1
+32:move.w  d1, MAP_CAM_X(a0)
+
+  move.w   MAP_TOP(a0), d0
+  lsl.w    #3, d0
+  move.w   MAP_CAM_Y(a0), d1
+  cmp.w    d0, d1
+  bcc      33f
+  move.w   d0, d1
+  bra      34f
+33:move.w  MAP_ROWS(a0), d2
+  lsl.w    #3, d2
+  sub.w    MAP_VIEW_H(a0), d2
+  add.w    d0, d2
+  cmp.w    d2, d1
+  bls      34f
+  move.w   d2, d1
+34:move.w  d1, MAP_CAM_Y(a0)
+
+  move.w   MAP_CAM_X(a0), d0
+  POPM     d2-d7/a2-a4
+  rts
+
+/**
+ * @brief Keep the camera within the map
+ * @param[in] A0.l Pointer to the map state
+ * @param[in] D0.w Camera X
+ * @param[in] D1.w Camera Y
+ * @param[out] D0.w Camera X
+ * @param[out] D1.w Camera Y
+ */
+map_clamp:
+  tst.w    d0
+  bpl      1f
+  moveq    #0, d0
+1:cmp.w    MAP_MAX_X(a0), d0
+  ble      2f
+  move.w   MAP_MAX_X(a0), d0
+2:tst.w    d1
+  bpl      3f
+  moveq    #0, d1
+3:cmp.w    MAP_MAX_Y(a0), d1
+  ble      4f
+  move.w   MAP_MAX_Y(a0), d1
+4:move.w   d0, MAP_CAM_X(a0)
+  move.w   d1, MAP_CAM_Y(a0)
+  rts
+
+/**
+ * @brief Draw a cell column over the rows in the plane
+ * @param[in] A0.l Pointer to the map state
+ * @param[in] D0.w Column (in cells, from the left of the map)
+ * @param[in] D5.w 0 to queue for DMA, otherwise write to the VDP now
+ * @param[out] CS The DMA queue was full
+ * @clobber d0-d4/a1-a4
+ */
+map_column:
+  move.w   MAP_WIDTH(a0), d1
+  add.w    d1, d1
+  cmp.w    d1, d0
+  bcc      9f                      // past the edge, never shown
+
+  move.w   d5, -(sp)
+  move.w   d0, -(sp)
+
+  // expand the metatiles down the column into the buffer
+  movea.l  MAP_BUF_PTR(a0), a3
+  movea.l  a3, a4
+  movea.l  MAP_DATA(a0), a1
+  move.w   MAP_TOP(a0), d1
+  moveq    #1, d5
+  and.w    d1, d5
+  lsl.w    #2, d5                  // 4 for the bottom half of a metatile
+  lsr.w    #1, d1
+  mulu.w   MAP_WIDTH(a0), d1
+  adda.l   d1, a1
+  move.w   d0, d1
+  lsr.w    #1, d1
+  adda.w   d1, a1
+  movea.l  MAP_METATILES(a0), a2
+  andi.w   #1, d0
+  add.w    d0, d0
+  adda.w   d0, a2                  // right half of a metatile
+  move.w   MAP_WIDTH(a0), d3
+  move.w   MAP_ATTR(a0), d4
+  move.w   MAP_ROWS(a0), d1
+  subq.w   #1, d1
+1:moveq    #0, d0
+  move.b   (a1), d0
+  lsl.w    #3, d0
+  add.w    d5, d0
+  move.w   (a2,d0.w), d2
+  add.w    d4, d2
+  move.w   d2, (a4)+
+  eori.w   #4, d5
+  bne      2f
+  adda.w   d3, a1
+2:dbf      d1, 1b
+  move.l   a4, MAP_BUF_PTR(a0)
+
+  move.w   (sp)+, d0
+  move.w   (sp)+, d5
+  move.w   MAP_PLANE_W(a0), d4
+  subq.w   #1, d4
+  and.w    d4, d0                  // x in the plane
+  add.w    d0, d0
+  add.w    MAP_PLANE(a0), d0
+  move.w   d0, d1                  // wraps to the top of the plane
+  move.w   MAP_PLANE_H(a0), d3
+  move.w   MAP_TOP(a0), d2
+  subq.w   #1, d3
+  and.w    d3, d2                  // y in the plane
+  addq.w   #1, d3
+  sub.w    d2, d3                  // cells before the wrap
+  mulu.w   MAP_PLANE_W(a0), d2
+  add.w    d2, d2
+  add.w    d2, d0
+  move.w   MAP_ROWS(a0), d2
+  move.w   MAP_PLANE_W(a0), d4
+  add.w    d4, d4                  // one line down
+  bra      map_send
+
+9:move     #0, ccr
+  rts
+
+/**
+ * @brief Draw a cell row over the columns in the plane
+ * @param[in] A0.l Pointer to the map state
+ * @param[in] D0.w Row (in cells, from the top of the map)
+ * @param[in] D5.w 0 to queue for DMA, otherwise write to the VDP now
+ * @param[out] CS The DMA queue was full
+ * @clobber d0-d4/a1-a4
+ */
+map_row:
+  move.w   MAP_HEIGHT(a0), d1
+  add.w    d1, d1
+  cmp.w    d1, d0
+  bcc      9f                      // past the edge, never shown
+
+  move.w   d5, -(sp)
+  move.w   d0, -(sp)
+
+  // expand the metatiles across the row into the buffer
+  movea.l  MAP_BUF_PTR(a0), a3
+  movea.l  a3, a4
+  movea.l  MAP_METATILES(a0), a2
+  moveq    #1, d1
+  and.w    d0, d1
+  lsl.w    #2, d1
+  adda.w   d1, a2                  // bottom half of a metatile
+  lsr.w    #1, d0
+  mulu.w   MAP_WIDTH(a0), d0
+  movea.l  MAP_DATA(a0), a1
+  adda.l   d0, a1
+  move.w   MAP_LEFT(a0), d0
+  moveq    #1, d5
+  and.w    d0, d5
+  add.w    d5, d5                  // 2 for the right half of a metatile
+  lsr.w    #1, d0
+  adda.w   d0, a1
+  move.w   MAP_ATTR(a0), d4
+  move.w   MAP_COLS(a0), d1
+  subq.w   #1, d1
+1:moveq    #0, d0
+  move.b   (a1), d0
+  lsl.w    #3, d0
+  add.w    d5, d0
+  move.w   (a2,d0.w), d2
+  add.w    d4, d2
+  move.w   d2, (a4)+
+  eori.w   #2, d5
+  bne      2f
+  addq.l   #1, a1
+2:dbf      d1, 1b
+  move.l   a4, MAP_BUF_PTR(a0)
+
+  move.w   (sp)+, d0
+  move.w   (sp)+, d5
+  move.w   MAP_PLANE_H(a0), d1
+  subq.w   #1, d1
+  and.w    d1, d0                  // y in the plane
+  mulu.w   MAP_PLANE_W(a0), d0
+  add.w    d0, d0
+  add.w    MAP_PLANE(a0), d0
+  move.w   d0, d1                  // wraps to the start of the line
+  move.w   MAP_PLANE_W(a0), d3
+  move.w   MAP_LEFT(a0), d2
+  subq.w   #1, d3
+  and.w    d3, d2                  // x in the plane
+  addq.w   #1, d3
+  sub.w    d2, d3                  // cells before the wrap
+  add.w    d2, d2
+  add.w    d2, d0
+  move.w   MAP_COLS(a0), d2
+  moveq    #2, d4
+  bra      map_send
+
+9:move     #0, ccr
+  rts
+
+/**
+ * @brief Send a strip to the plane, in two parts if it wraps
+ * @param[in] A0.l Pointer to the map state
+ * @param[in] A3.l Strip
+ * @param[in] D0.w VRAM address of the first cell
+ * @param[in] D1.w VRAM address after the wrap
+ * @param[in] D2.w Number of cells
+ * @param[in] D3.w Number of cells before the wrap
+ * @param[in] D4.w VDP auto increment
+ * @param[in] D5.w 0 to queue for DMA, otherwise write to the VDP now
+ * @param[out] CS The DMA queue was full
+ * @clobber d0-d3/a1/a3
+ */
+map_send:
+  cmp.w    d3, d2
+  bhi      1f
+  move.w   d2, d3
+1:sub.w    d3, d2                  // cells after the wrap
+  PUSHM    d1-d2
+  move.w   d3, d2
+  bsr      2f
+  POPM     d1-d2
+  bcs      9f
+  tst.w    d2
+  beq      9f
+  move.w   d1, d0
+
+  // send d2 cells from a3 to d0
+2:TO_VDPPTR d0
+  ori.l    #VRAM_W, d0
+  tst.w    d5
+  bne      3f
+  move.l   a0, -(sp)
+  move.l   a3, d1
+  move.w   #(DMAQ_FLAG_WHOLE << 8) | MAP_DMA_PRIORITY, d3
+  jsr      dmaq_push_stride
+  movea.l  (sp)+, a0
+  adda.w   d2, a3
+  adda.w   d2, a3
+9:rts
+
+3:move.w   #VDP_REG_AUTOINC, d1
+  move.b   d4, d1
+  move.w   d1, (VDP_CTRL).l
+  move.l   d0, (VDP_CTRL).l
+  move.w   d2, d1
+  subq.w   #1, d1
+4:move.w   (a3)+, (VDP_DATA).l
+  dbf      d1, 4b
+  move.w   #VDP_REG_AUTOINC | 2, (VDP_CTRL).l
+  move     #0, ccr
+  rts
+
+#endif
@@ -53,6 +53,14 @@
 #define WORD_RAM_1M_BANK2 0x220000
 #endif
 
+/**
+ * @brief Size of each Word RAM bank in 1M mode
+ * @details In 1M mode, the Main CPU sees its bank at WORD_RAM_1M_BANK1,
+ * whichever physical bank that is, so code linked there can run from either
+ * bank.
+ */
+#define WORD_RAM_1M_SIZE 0x20000
+
 /**
  * @brief Bass address for Sub CPU PRG RAM 1M mapping
  */
@@ -0,0 +1,92 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/mmd.def.h
+ * @brief MMD module header layout and flags
+ *
+ * @details
+ * The header is built by cfg/module_mmd.ld:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | word | Flags
+ * 0x02   | long | Runtime location (MMD_DEST), or 0 to run in place
+ * 0x06   | word | Size of the module data in longs, minus 1
+ * 0x08   | long | Entry point
+ * 0x0C   | long | HBLANK handler, or 0
+ * 0x10   | long | VBLANK handler, or 0
+ * 0x14   | long | Size of the .init section in bytes
+ * 0x18   | long | Offset of the relocation table from the module data, or 0
+ * 0x1C   | long | Linked address of the module data (MODULE_ROM_ORIGIN)
+ * 0x20   | ...  | Padding up to 0x100
+ *
+ * When the module is compressed, the .init section is stored as is after the
+ * header, followed by:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | long | Size of the compressed data in bytes
+ * 0x04   | long | Space needed to unpack the data in place
+ * 0x08   | ...  | Kosinski compressed data
+ *
+ * When the module is relocatable, the relocation table follows the module
+ * data and is included in the copy count. It lists each absolute long which
+ * points into the module, as a series of advances (see tools/mmd_reloc.sh):
+ *
+ * Bytes   | Meaning
+ * --------|--------
+ * 00      | End of table
+ * 01-7F   | Advance by (value * 2) bytes and relocate
+ * 8x xx   | Advance by ((value & 0x7FFF) * 2) bytes and relocate
+ * 80 00   | Advance by 0xFFFE bytes without relocating
+ *
+ * Advances begin from two bytes before the start of the module data.
+ */
+
+#ifndef MEGADEV__MAIN_MMD_DEF_H
+#define MEGADEV__MAIN_MMD_DEF_H
+
+#define MMD_HEADER_FLAGS       0x00
+#define MMD_HEADER_DEST        0x02
+#define MMD_HEADER_COPY_COUNT  0x06
+#define MMD_HEADER_ENTRY       0x08
+#define MMD_HEADER_HBLANK      0x0C
+#define MMD_HEADER_VBLANK      0x10
+#define MMD_HEADER_INIT_LENGTH 0x14
+#define MMD_HEADER_RELOC       0x18
+#define MMD_HEADER_ORIGIN      0x1C
+#define MMD_HEADER_SIZE        0x100
+
+/**
+ * @def MMD_BIT_RETURN_2M
+ * @brief Return 2M Word RAM to the Sub CPU before jumping to the entry point
+ * @note Bit numbers are within the first (upper) byte of the flags
+ */
+#define MMD_BIT_RETURN_2M 6
+
+/**
+ * @def MMD_BIT_COMPRESSED
+ * @brief Module data after the .init section is compressed
+ * @details Set in MMD_FLAGS to have the build compress the module (see
+ * tools/mmd_compress.sh). The loader must be built with MMD_COMPRESS.
+ */
+#define MMD_BIT_COMPRESSED 5
+
+/**
+ * @def MMD_BIT_RELOCATABLE
+ * @brief Module may be placed at an address other than the one it was linked
+ * for
+ * @details Set in MMD_FLAGS to have the build add a relocation table (see
+ * tools/mmd_reloc.sh). The loader must be built with MMD_RELOCATABLE.
+ */
+#define MMD_BIT_RELOCATABLE 4
+
+/**
+ * @def MMD_FLAG_RETURN_2M
+ * @brief Flag values for use with the MMD_FLAGS symbol
+ */
+#define MMD_FLAG_RETURN_2M   (1 << (MMD_BIT_RETURN_2M + 8))
+#define MMD_FLAG_COMPRESSED  (1 << (MMD_BIT_COMPRESSED + 8))
+#define MMD_FLAG_RELOCATABLE (1 << (MMD_BIT_RELOCATABLE + 8))
+
+#endif
@@ -4,6 +4,13 @@
  * @file mmd.h
  * @brief Set up and run a loaded MMD formatted module
  * @note This expects a module to be already loaded at the start of Word RAM
+ *
+ * @details
+ * When built with MMD_COMPRESS, modules with MMD_FLAG_COMPRESSED set are
+ * unpacked instead of copied. When built with MMD_RELOCATABLE, modules with
+ * MMD_FLAG_RELOCATABLE set are relocated to MMD_DEST after they are copied,
+ * and can be placed anywhere with @ref init_mmd_at. Be sure to include mmd.s
+ * in your module when using either.
  */
 
 #ifndef MEGADEV__MAIN_INIT_MMD_H
@@ -11,6 +18,40 @@
 
 #include <main/gate_arr.h>
 #include <main/memmap.h>
+#include <main/mmd.def.h>
+
+/*
+ * Prepended to the init_mmd asm; skips the copy for a compressed module
+ */
+#ifdef MMD_COMPRESS
+#define MMD_INIT_UNPACK \
+  "\
+  btst     #%c[mmd_compressed], (%[wrdram]) \n\
+  beq      5f \n\
+  movea.l  %[wrdram], a0 \n\
+  jsr      mmd_unpack \n\
+  bra      1f \n\
+5: \n\
+"
+#else
+#define MMD_INIT_UNPACK ""
+#endif
+
+/*
+ * Inserted after the copy in the init_mmd asm
+ */
+#ifdef MMD_RELOCATABLE
+#define MMD_INIT_RELOCATE \
+  "\
+  btst     #%c[mmd_relocatable], (%[wrdram]) \n\
+  beq      7f \n\
+  movea.l  %[wrdram], a0 \n\
+  jsr      mmd_relocate \n\
+7: \n\
+"
+#else
+#define MMD_INIT_RELOCATE ""
+#endif
 
 static inline void const * init_mmd()
 {
@@ -21,6 +62,7 @@ static inline void const * init_mmd()
 
   // clang-format off
 	asm volatile(
+		MMD_INIT_UNPACK
 		"\
   move.l   2(%[wrdram]), %[scratch_d0] \n\
   beq      1f \n\
@@ -29,13 +71,17 @@ static inline void const * init_mmd()
   move.w   6(%[wrdram]), %[scratch_d0] \n\
 0:move.l   (%[scratch_a1])+, (%[scratch_a0])+ \n\
   dbf      %[scratch_d0], 0b \n\
-1:move.l   12(%[wrdram]), %[scratch_d0] \n\
+1: \n\
+"
+		MMD_INIT_RELOCATE
+		"\
+  move.l   12(%[wrdram]), %[scratch_d0] \n\
   beq      2f \n\
   move.l   %[scratch_d0], %c[mlevel4]+2 \n\
 2:move.l   16(%[wrdram]), %[scratch_d0] \n\
   beq      3f \n\
   move.l   %[scratch_d0], %c[mlevel6]+2 \n\
-3:btst     #6, (%[wrdram]) \n\
+3:btst     #%c[mmd_return_2m], (%[wrdram]) \n\
   beq      4f \n\
 6:bset     #%c[ga_dmna], %c[ga_memmode]+1 \n\
   btst     #%c[ga_dmna], %c[ga_memmode]+1 \n\
@@ -52,12 +98,100 @@ static inline void const * init_mmd()
 			[mlevel4] "i"(EXVEC_LEVEL4),
 			[mlevel6] "i"(EXVEC_LEVEL6),
 			[ga_dmna] "i"(GA_BIT_DMNA),
-			[ga_memmode] "i"(GA_REG_MEMMODE)
+			[ga_memmode] "i"(GA_REG_MEMMODE),
+			[mmd_return_2m] "i"(MMD_BIT_RETURN_2M),
+			[mmd_compressed] "i"(MMD_BIT_COMPRESSED),
+			[mmd_relocatable] "i"(MMD_BIT_RELOCATABLE)
 		:
-			"cc");
+			"a0", "cc", "memory");
   // clang-format on
 
   return mmd_entry;
 }
 
+/**
+ * @fn init_mmd_1m
+ * @brief Set up an MMD module in the Main CPU Word RAM bank in 1M mode
+ * @return Pointer to the module entry point
+ * @details Identical to @ref init_mmd, except that in 1M mode the Main CPU
+ * always has access to its bank, so there is no Word RAM handshake and the
+ * header flag to return Word RAM is ignored. This is meant for modules
+ * preloaded into the Sub CPU bank and then swapped in.
+ */
+static inline void const * init_mmd_1m()
+{
+  register void const * mmd_entry;
+  register u32          scratch_d0, scratch_a0, scratch_a1;
+
+  // clang-format off
+	asm volatile(
+		MMD_INIT_UNPACK
+		"\
+  move.l   2(%[wrdram]), %[scratch_d0] \n\
+  beq      1f \n\
+  movea.l  %[scratch_d0], %[scratch_a0] \n\
+  lea      0x100(%[wrdram]), %[scratch_a1] \n\
+  move.w   6(%[wrdram]), %[scratch_d0] \n\
+0:move.l   (%[scratch_a1])+, (%[scratch_a0])+ \n\
+  dbf      %[scratch_d0], 0b \n\
+1: \n\
+"
+		MMD_INIT_RELOCATE
+		"\
+  move.l   12(%[wrdram]), %[scratch_d0] \n\
+  beq      2f \n\
+  move.l   %[scratch_d0], %c[mlevel4]+2 \n\
+2:move.l   16(%[wrdram]), %[scratch_d0] \n\
+  beq      3f \n\
+  move.l   %[scratch_d0], %c[mlevel6]+2 \n\
+3:movea.l  8(%[wrdram]), %[mmd_entry] \n\
+	"
+		:
+			[mmd_entry] "=a"(mmd_entry),
+			[scratch_d0] "=d"(scratch_d0),
+			[scratch_a0] "=a"(scratch_a0),
+			[scratch_a1] "=a"(scratch_a1)
+		:
+			[wrdram] "a"(WORD_RAM_1M_BANK1),
+			[mlevel4] "i"(EXVEC_LEVEL4),
+			[mlevel6] "i"(EXVEC_LEVEL6),
+			[mmd_compressed] "i"(MMD_BIT_COMPRESSED),
+			[mmd_relocatable] "i"(MMD_BIT_RELOCATABLE)
+		:
+			"a0", "cc", "memory");
+  // clang-format on
+
+  return mmd_entry;
+}
+
+#ifdef MMD_RELOCATABLE
+/**
+ * @fn init_mmd_at
+ * @brief Set up an MMD module at a location chosen at runtime
+ * @param dest Location for the module data, or NULL to run it in place
+ * @return Pointer to the module entry point
+ * @details Replaces MMD_DEST in the header, then continues as
+ * @ref init_mmd. The module must have MMD_FLAG_RELOCATABLE set, and dest must
+ * have room for the module data plus its relocation table.
+ */
+static inline void const * init_mmd_at(void * dest)
+{
+  wait_2m();
+  *((void * volatile *) (WORD_RAM + MMD_HEADER_DEST)) = dest;
+  return init_mmd();
+}
+
+/**
+ * @fn init_mmd_1m_at
+ * @brief Set up an MMD module in the Main CPU bank at a location chosen at
+ * runtime
+ * @details As @ref init_mmd_at, for @ref init_mmd_1m
+ */
+static inline void const * init_mmd_1m_at(void * dest)
+{
+  *((void * volatile *) (WORD_RAM_1M_BANK1 + MMD_HEADER_DEST)) = dest;
+  return init_mmd_1m();
+}
+#endif
+
 #endif
@@ -8,20 +8,137 @@
 #define MEGADEV__MAIN_INIT_MMD_S
 
 #include "macros.s"
+#include <system.macros.s>
+#include <kos_cmp.macros.s>
 #include <main/memmap.def.h>
+#include <main/mmd.def.h>
 #include <main/gate_arr.def.h>
 #include <main/gate_arr.macros.s>
 
+/**
+ * @fn MMD_UNPACK
+ * @brief Unpack a compressed MMD module
+ * @param[in] A0.l Pointer to the module header
+ * @details The .init section is copied as is and the rest of the module is
+ * decompressed after it, either to MMD_DEST or, if that is 0, in place. In
+ * place, the compressed data is first moved to the end of the space given in
+ * its block header (see main/mmd.def.h), so that the output never overtakes
+ * the input.
+ *
+ * Uses only relative branches, so it may be used in a .init section. Local
+ * labels 10 to 29 are used.
+ */
+.macro MMD_UNPACK
+  PUSHM    d0-d6/a0-a3
+  lea      MMD_HEADER_SIZE(a0), a1          // .init as stored
+  move.l   MMD_HEADER_INIT_LENGTH(a0), d0
+  lea      (a1,d0.l), a3                    // compressed data block
+  move.l   MMD_HEADER_DEST(a0), d1
+  beq      14f                              // no destination, unpack in place
+
+  // copy .init, then unpack directly after it
+  movea.l  d1, a2
+  lsr.l    #2, d0
+  bra      11f
+10:move.l  (a1)+, (a2)+
+11:dbf     d0, 10b
+  movea.l  a2, a1
+  lea      8(a3), a0
+  bra      18f
+
+  // move the compressed data to the end of the space, working backward since
+  // the two overlap, then unpack over the block header
+14:movea.l a3, a1
+  move.l   (a3)+, d0                        // compressed size
+  move.l   (a3)+, d1                        // in place space
+  lea      (a1,d1.l), a2
+  lea      (a3,d0.l), a0
+  lsr.l    #2, d0
+  bra      16f
+15:move.l  -(a0), -(a2)
+16:dbf     d0, 15b
+  movea.l  a2, a0
+
+18:KOS_DECOMP
+  POPM     d0-d6/a0-a3
+.endm
+
+/**
+ * @fn MMD_RELOCATE
+ * @brief Relocate a module which has been copied or unpacked to MMD_DEST (or
+ * is in place, if that is 0)
+ * @param[in] A0.l Pointer to the module header
+ * @details Adds the difference between the module location and its linked
+ * address to each long listed in the relocation table (see main/mmd.def.h),
+ * and to the entry point and interrupt handlers in the header. Nothing is
+ * done if the module is already where it was linked for. Local labels 30 to
+ * 39 are used.
+ */
+.macro MMD_RELOCATE
+  PUSHM    d0-d4/a0-a2
+  lea      MMD_HEADER_SIZE(a0), a1
+  move.l   MMD_HEADER_DEST(a0), d0
+  beq      30f
+  movea.l  d0, a1
+30:move.l  MMD_HEADER_ORIGIN(a0), d4
+  move.l   a1, d1
+  sub.l    d4, d1                           // distance moved
+  beq      39f
+  move.l   MMD_HEADER_RELOC(a0), d0         // also the size of the module data
+  beq      39f
+  lea      (a1,d0.l), a2
+
+  // entry point and interrupt handlers, if they are within the module
+  addq.l   #MMD_HEADER_ENTRY, a0
+  moveq    #2, d3
+31:move.l  (a0)+, d2
+  sub.l    d4, d2
+  cmp.l    d0, d2
+  bcc      32f
+  add.l    d1, -4(a0)
+32:dbf     d3, 31b
+
+  subq.l   #2, a1
+33:moveq   #0, d2
+  move.b   (a2)+, d2
+  beq      39f
+  bpl      35f
+  andi.b   #0x7F, d2
+  lsl.w    #8, d2
+  move.b   (a2)+, d2
+  tst.w    d2                               // the low byte may be 0
+  bne      35f
+  adda.l   #0xFFFE, a1
+  bra      33b
+35:add.l   d2, d2
+  adda.l   d2, a1
+  add.l    d1, (a1)
+  bra      33b
+
+39:POPM    d0-d4/a0-a2
+.endm
+
 /**
  * @fn INIT_MMD
  * @brief Initialize MMD formatted module
  * @note This expects a module to be already loaded at the start of Word RAM
+ * @note When built with MMD_COMPRESS, compressed modules are unpacked with
+ * MMD_UNPACK
+ * @note When built with MMD_RELOCATABLE, relocatable modules are relocated to
+ * MMD_DEST (which may be changed in the header beforehand) with MMD_RELOCATE
  * @return a0 pointer to module entry point
  * @clobber d0, a0-a2
  */
 .macro INIT_MMD
   WAIT_2M
   lea      WORD_RAM, a0	//get MMD entry point
+#ifdef MMD_COMPRESS
+  btst     #MMD_BIT_COMPRESSED, (a0)
+  beq      5f
+  MMD_UNPACK
+  bra      1f
+5:
+#endif
   move.l   2(a0), d0	//get MMD data destination
   beq      1f             //if no destination, skip the copy
   movea.l  d0, a2         //put destination in a2
@@ -29,16 +146,63 @@
   move.w   6(a0), d0  //size of MMD Data in d7
 0:move.l   (a1)+, (a2)+   //copy MMD Data to destination
   dbf      d0, 0b
-1:move.l   12(a0), d0  //set HBLANK vector if provided
+1:
+#ifdef MMD_RELOCATABLE
+  btst     #MMD_BIT_RELOCATABLE, (a0)
+  beq      6f
+  MMD_RELOCATE
+6:
+#endif
+  move.l   12(a0), d0  //set HBLANK vector if provided
   beq      2f
   move.l   d0, EXVEC_LEVEL4
 2:move.l   16(a0), d0
   beq      3f
   move.l   d0, EXVEC_LEVEL6
-3:btst     #6, WORD_RAM    // if bit 6 is set, return 2m to sub 
+3:btst     #MMD_BIT_RETURN_2M, WORD_RAM    // if bit 6 is set, return 2m to sub 
   beq      4f
   GRANT_2M
 4:movea.l  8(a0), a0
 .endm
 
+/**
+ * @fn INIT_MMD_1M
+ * @brief Initialize MMD formatted module in the Main CPU bank in 1M mode
+ * @note As INIT_MMD, but without the Word RAM handshake, which does not apply
+ * in 1M mode
+ * @return a0 pointer to module entry point
+ * @clobber d0, a0-a2
+ */
+.macro INIT_MMD_1M
+  lea      WORD_RAM_1M_BANK1, a0
+#ifdef MMD_COMPRESS
+  btst     #MMD_BIT_COMPRESSED, (a0)
+  beq      5f
+  MMD_UNPACK
+  bra      1f
+5:
+#endif
+  move.l   2(a0), d0
+  beq      1f
+  movea.l  d0, a2
+  lea      0x100(a0), a1
+  move.w   6(a0), d0
+0:move.l   (a1)+, (a2)+
+  dbf      d0, 0b
+1:
+#ifdef MMD_RELOCATABLE
+  btst     #MMD_BIT_RELOCATABLE, (a0)
+  beq      6f
+  MMD_RELOCATE
+6:
+#endif
+  move.l   12(a0), d0
+  beq      2f
+  move.l   d0, EXVEC_LEVEL4
+2:move.l   16(a0), d0
+  beq      3f
+  move.l   d0, EXVEC_LEVEL6
+3:movea.l  8(a0), a0
+.endm
+
 #endif
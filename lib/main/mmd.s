@@ -0,0 +1,41 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/mmd.s
+ * @brief Compressed and relocatable MMD module support for init_mmd
+ *
+ * @details
+ * Needed by init_mmd() and init_mmd_1m() in main/mmd.h when built with
+ * MMD_COMPRESS or MMD_RELOCATABLE. Modules written in asm use the MMD_UNPACK
+ * and MMD_RELOCATE macros directly.
+ */
+
+#ifndef MEGADEV__MAIN_MMD_S
+#define MEGADEV__MAIN_MMD_S
+
+#include <macros.s>
+#include <main/mmd.macros.s>
+
+.section .text
+
+/**
+ * @fn mmd_unpack
+ * @brief Unpack a compressed MMD module
+ * @param[in] A0.l Pointer to the module header
+ * @clobber none
+ */
+SUB mmd_unpack
+  MMD_UNPACK
+  rts
+
+/**
+ * @fn mmd_relocate
+ * @brief Relocate a module which has been copied to MMD_DEST
+ * @param[in] A0.l Pointer to the module header
+ * @clobber none
+ */
+SUB mmd_relocate
+  MMD_RELOCATE
+  rts
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/palfx.def.h
+ * @brief Palette effects definitions
+ *
+ * @details
+ * Each running fade has a slot in this format:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | long | Pointer to the target colors, or 0 to fade to one color
+ * 0x04   | long | Position (0x10000 is the end of the fade)
+ * 0x08   | long | Step per frame
+ * 0x0C   | byte | First palette entry (0 to 63)
+ * 0x0D   | byte | Number of entries
+ * 0x0E   | byte | Blend level last applied
+ * 0x0F   | byte | Flags
+ * 0x10   | word | Target color, when fading to one color
+ * 0x12   | 64 words | Colors at the start of the fade
+ */
+
+#ifndef MEGADEV__MAIN_PALFX_DEF_H
+#define MEGADEV__MAIN_PALFX_DEF_H
+
+#define PALFX_TO     0x00
+#define PALFX_POS    0x04
+#define PALFX_STEP   0x08
+#define PALFX_FIRST  0x0C
+#define PALFX_COUNT  0x0D
+#define PALFX_LEVEL  0x0E
+#define PALFX_FLAGS  0x0F
+#define PALFX_COLOR  0x10
+#define PALFX_FROM   0x12
+#define PALFX_SIZE   (PALFX_FROM + 64 * 2)
+
+#define PALFX_BIT_ACTIVE  0
+#define PALFX_FLAG_ACTIVE (1 << PALFX_BIT_ACTIVE)
+
+/**
+ * @def PALFX_SLOTS
+ * @brief Largest number of fades running at once
+ */
+#ifndef PALFX_SLOTS
+#define PALFX_SLOTS 4
+#endif
+
+/**
+ * @def PALFX_LEVELS
+ * @brief Number of blend steps between two colors
+ * @details A color channel has 8 levels, so there is nothing to gain from
+ * more steps than that.
+ */
+#define PALFX_LEVELS 8
+
+/**
+ * @def PALFX_RATE_NTSC
+ * @brief Numerator of the step per frame on 60Hz hardware
+ * @details Durations are given in 1/60 second ticks, so on 50Hz hardware the
+ * step is 6/5 larger.
+ */
+#define PALFX_RATE_NTSC 0x10000
+#define PALFX_RATE_PAL  0x13333
+
+/**
+ * @def PALFX_DMA_PRIORITY
+ * @brief Priority of palette updates in the DMA queue
+ */
+#ifndef PALFX_DMA_PRIORITY
+#define PALFX_DMA_PRIORITY 0
+#endif
+
+#endif
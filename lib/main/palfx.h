@@ -0,0 +1,192 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/palfx.h
+ * @brief Palette effects
+ *
+ * @details
+ * Fades and crossfades between any two palettes, or from a palette to a
+ * single color, on any range of entries, with several running at once. The
+ * engine keeps its own working palette and sends only the entries which
+ * changed, through the DMA queue (see main/dmaq.h).
+ *
+ *   palfx_init_c();
+ *   palfx_set_c(title_pal, 0, 16);
+ *
+ *   // fade the title in from black over half a second
+ *   palfx_fade_c(black_pal, title_pal, 0, 16, 30);
+ *   // fade the sprite palette to white over a second
+ *   palfx_fade_to_color_c(48, 16, 0xEEE, 60);
+ *
+ *   // each frame
+ *   palfx_update_c();
+ *   palfx_flush_c();
+ *
+ * The blend of each channel comes from a table built by palfx_init_c, and a
+ * fade only works out its colors again when it reaches a new blend level, so
+ * most frames cost only a few instructions per fade. Durations are in 1/60
+ * second ticks and take as long on 50Hz hardware.
+ *
+ * These do not use the Boot ROM palette cache (bios_palette), so avoid
+ * bios_load_pal_update and the other calls which set the palette update bit
+ * in bios_vdp_update_flags, or the Boot ROM will overwrite CRAM.
+ *
+ * Be sure to include palfx_main.s, dmaq_main.s and vdp.s in your module when
+ * using these.
+ */
+
+#ifndef MEGADEV__MAIN_PALFX_H
+#define MEGADEV__MAIN_PALFX_H
+
+#include "main/palfx.def.h"
+#include "types.h"
+
+/**
+ * @var palfx_pal
+ * @brief Working palette
+ * @details Change it with @ref palfx_set_c, so that the changes are sent.
+ */
+extern u16 const palfx_pal[64];
+
+/**
+ * @var palfx_running
+ * @brief Number of fades running
+ */
+extern u16 volatile palfx_running;
+
+/**
+ * @fn palfx_init_c
+ * @brief Stop all fades and build the blend table
+ */
+static inline void palfx_init_c()
+{
+  asm volatile(
+    "\
+  jsr palfx_init \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "cc", "memory");
+}
+
+/**
+ * @fn palfx_set_c
+ * @brief Set colors in the working palette
+ * @param colors Colors
+ * @param first First entry (0 to 63)
+ * @param count Number of entries
+ */
+static inline void palfx_set_c(u16 const * colors, u16 first, u16 count)
+{
+  register u32 a0_colors asm("a0") = (u32) colors;
+  register u16 d0_first asm("d0") = first;
+  register u16 d1_count asm("d1") = count;
+
+  asm volatile(
+    "\
+  jsr palfx_set \n\
+		"
+    : "+a"(a0_colors), "+d"(d0_first), "+d"(d1_count)
+    :
+    : "cc", "memory");
+}
+
+/**
+ * @fn palfx_fade_c
+ * @brief Start a fade between two palettes
+ * @param from Colors to fade from, or NULL to fade from the working palette
+ * @param to Colors to fade to
+ * @param first First entry (0 to 63)
+ * @param count Number of entries
+ * @param ticks Duration (in 1/60 second ticks)
+ * @return false if no slot was free
+ * @note The target colors must stay in place until the fade is done
+ */
+static inline bool palfx_fade_c(
+  u16 const * from, u16 const * to, u16 first, u16 count, u16 ticks)
+{
+  register u32 a0_from asm("a0") = (u32) from;
+  register u32 a1_to asm("a1") = (u32) to;
+  register u16 d0_first asm("d0") = first;
+  register u16 d1_count asm("d1") = count;
+  register u16 d2_ticks asm("d2") = ticks;
+  register u8  result;
+
+  asm volatile(
+    "\
+  jsr palfx_fade \n\
+  scc %[result] \n\
+		"
+    : "+a"(a0_from), "+a"(a1_to), "+d"(d0_first), "+d"(d1_count),
+      [result] "=d"(result)
+    : "d"(d2_ticks)
+    : "cc", "memory");
+
+  return result;
+}
+
+/**
+ * @fn palfx_fade_to_color_c
+ * @brief Start a fade of part of the working palette to a single color
+ * @param first First entry (0 to 63)
+ * @param count Number of entries
+ * @param color Color to fade to, e.g. 0 for black
+ * @param ticks Duration (in 1/60 second ticks)
+ * @return false if no slot was free
+ */
+static inline bool palfx_fade_to_color_c(
+  u16 first, u16 count, u16 color, u16 ticks)
+{
+  register u32 a0_from asm("a0") = 0;
+  register u32 a1_to asm("a1") = 0;
+  register u16 d0_first asm("d0") = first;
+  register u16 d1_count asm("d1") = count;
+  register u16 d2_ticks asm("d2") = ticks;
+  register u16 d3_color asm("d3") = color;
+  register u8  result;
+
+  asm volatile(
+    "\
+  jsr palfx_fade \n\
+  scc %[result] \n\
+		"
+    : "+a"(a0_from), "+a"(a1_to), "+d"(d0_first), "+d"(d1_count),
+      [result] "=d"(result)
+    : "d"(d2_ticks), "d"(d3_color)
+    : "cc", "memory");
+
+  return result;
+}
+
+/**
+ * @fn palfx_update_c
+ * @brief Advance the running fades
+ * @note Call once per frame
+ */
+static inline void palfx_update_c()
+{
+  asm volatile(
+    "\
+  jsr palfx_update \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+/**
+ * @fn palfx_flush_c
+ * @brief Queue the changed entries of the working palette for DMA
+ */
+static inline void palfx_flush_c()
+{
+  asm volatile(
+    "\
+  jsr palfx_flush \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+#endif
@@ -0,0 +1,368 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/palfx_main.s
+ * @brief Palette effects
+ *
+ * @details
+ * See palfx.def.h for the fade slot format and main/palfx.h for usage.
+ * Changed entries are sent through the DMA queue, so dmaq_main.s and vdp.s
+ * must be included in the module as well.
+ */
+
+#ifndef MEGADEV__MAIN_PALFX_S
+#define MEGADEV__MAIN_PALFX_S
+
+#include <macros.s>
+#include <main/dmaq.def.h>
+#include <main/palfx.def.h>
+#include <main/vdp.def.h>
+#include <main/vdp.macros.s>
+
+.section .text
+
+/**
+ * @fn palfx_init
+ * @brief Stop all fades and build the blend table
+ * @clobber d0-d1/a0
+ * @details The working palette is left as it is. Fade durations are scaled
+ * for 50Hz if the VDP reports PAL hardware.
+ */
+SUB palfx_init
+  PUSHM    d2-d4
+
+  // for each level t and pair of channel values a and b:
+  // (a * (8 - t) + b * t + 4) / 8, in the position of the red channel
+  lea      palfx_blend, a0
+  moveq    #0, d0
+1:moveq    #0, d1
+2:moveq    #0, d2
+3:moveq    #PALFX_LEVELS, d3
+  sub.w    d0, d3
+  mulu.w   d1, d3
+  move.w   d2, d4
+  mulu.w   d0, d4
+  add.w    d4, d3
+  addq.w   #PALFX_LEVELS / 2, d3
+  lsr.w    #3, d3
+  add.b    d3, d3
+  move.b   d3, (a0)+
+  addq.w   #1, d2
+  cmpi.w   #8, d2
+  bne      3b
+  addq.w   #1, d1
+  cmpi.w   #8, d1
+  bne      2b
+  addq.w   #1, d0
+  cmpi.w   #PALFX_LEVELS + 1, d0
+  bne      1b
+
+  lea      palfx_slots, a0
+  moveq    #PALFX_SLOTS - 1, d0
+4:clr.b    PALFX_FLAGS(a0)
+  lea      PALFX_SIZE(a0), a0
+  dbf      d0, 4b
+  clr.w    palfx_running
+  lea      palfx_dirty, a0
+  move.l   #0xFF00FF00, (a0)+
+  move.l   #0xFF00FF00, (a0)
+
+  move.l   #PALFX_RATE_NTSC, palfx_rate
+  btst     #0, (VDP_CTRL + 1).l       // VDPSTAT_MASK_PAL_HARDWARE
+  beq      5f
+  move.l   #PALFX_RATE_PAL, palfx_rate
+5:POPM     d2-d4
+  rts
+
+/**
+ * @fn palfx_set
+ * @brief Set colors in the working palette
+ * @param[in] A0.l Pointer to the colors
+ * @param[in] D0.w First entry (0 to 63)
+ * @param[in] D1.w Number of entries
+ * @clobber d0-d1/a0
+ * @details Only the entries which change are sent on the next flush.
+ */
+SUB palfx_set
+  PUSHM    d2/d4/d7/a3/a5
+  lea      palfx_dirty, a5
+  move.w   d0, d7
+  lea      palfx_pal, a3
+  add.w    d0, d0
+  adda.w   d0, a3
+  subq.w   #1, d1
+  bcs      2f
+1:move.w   (a0)+, d4
+  bsr      palfx_store
+  addq.l   #2, a3
+  addq.w   #1, d7
+  dbf      d1, 1b
+2:POPM     d2/d4/d7/a3/a5
+  rts
+
+/**
+ * @fn palfx_fade
+ * @brief Start a fade
+ * @param[in] A0.l Colors to fade from, or 0 to fade from the working palette
+ * @param[in] A1.l Colors to fade to, or 0 to fade every entry to D3.w
+ * @param[in] D0.w First entry (0 to 63)
+ * @param[in] D1.w Number of entries
+ * @param[in] D2.w Duration (in 1/60 second ticks)
+ * @param[in] D3.w Color to fade to, when A1.l is 0
+ * @param[out] CC Fade started
+ * @param[out] CS No free slot (see PALFX_SLOTS)
+ * @clobber d0-d1/a0-a1
+ * @details A running fade over any of the same entries is stopped, so a new
+ * fade takes over from wherever the last one had got to. The target colors
+ * must stay in place until the fade is done.
+ */
+SUB palfx_fade
+  PUSHM    d2-d6/a2
+
+  // stop fades over the same entries
+  lea      palfx_slots, a2
+  moveq    #PALFX_SLOTS - 1, d4
+1:btst     #PALFX_BIT_ACTIVE, PALFX_FLAGS(a2)
+  beq      2f
+  moveq    #0, d5
+  move.b   PALFX_FIRST(a2), d5
+  move.w   d0, d6
+  add.w    d1, d6
+  cmp.w    d6, d5
+  bcc      2f
+  moveq    #0, d6
+  move.b   PALFX_COUNT(a2), d6
+  add.w    d5, d6
+  cmp.w    d6, d0
+  bcc      2f
+  clr.b    PALFX_FLAGS(a2)
+  subq.w   #1, palfx_running
+2:lea      PALFX_SIZE(a2), a2
+  dbf      d4, 1b
+
+  // find a free slot
+  lea      palfx_slots, a2
+  moveq    #PALFX_SLOTS - 1, d4
+3:btst     #PALFX_BIT_ACTIVE, PALFX_FLAGS(a2)
+  beq      4f
+  lea      PALFX_SIZE(a2), a2
+  dbf      d4, 3b
+  POPM     d2-d6/a2
+  move     #1, ccr
+  rts
+
+4:move.l   a1, PALFX_TO(a2)
+  move.w   d3, PALFX_COLOR(a2)
+  move.b   d0, PALFX_FIRST(a2)
+  move.b   d1, PALFX_COUNT(a2)
+  st       PALFX_LEVEL(a2)
+  clr.l    PALFX_POS(a2)
+  cmpi.w   #1, d2
+  bhi      5f
+  move.l   #0x10000, d4            // done on the next update
+  bra      6f
+5:move.l   palfx_rate, d4
+  divu.w   d2, d4
+  andi.l   #0xFFFF, d4
+6:move.l   d4, PALFX_STEP(a2)
+
+  // keep the starting colors
+  move.l   a0, d4
+  bne      7f
+  lea      palfx_pal, a0
+  add.w    d0, d0
+  adda.w   d0, a0
+7:lea      PALFX_FROM(a2), a1
+  subq.w   #1, d1
+  bcs      9f
+8:move.w   (a0)+, (a1)+
+  dbf      d1, 8b
+
+9:move.b   #PALFX_FLAG_ACTIVE, PALFX_FLAGS(a2)
+  addq.w   #1, palfx_running
+  POPM     d2-d6/a2
+  move     #0, ccr
+  rts
+
+/**
+ * @fn palfx_update
+ * @brief Advance the running fades
+ * @clobber d0-d1/a0-a1
+ * @details Meant to be called once per frame. The entries of a fade are only
+ * worked out again when its blend level changes, which happens at most
+ * PALFX_LEVELS times over the fade; on other frames, a fade costs only its
+ * step.
+ */
+SUB palfx_update
+  PUSHM    d2-d7/a2-a5
+  lea      palfx_dirty, a5
+  lea      palfx_slots, a0
+  move.w   #PALFX_SLOTS - 1, -(sp)
+
+1:btst     #PALFX_BIT_ACTIVE, PALFX_FLAGS(a0)
+  beq      8f
+  move.l   PALFX_STEP(a0), d0
+  add.l    d0, PALFX_POS(a0)
+  move.l   PALFX_POS(a0), d0
+  cmpi.l   #0x10000, d0
+  bcs      2f
+  moveq    #PALFX_LEVELS, d0
+  clr.b    PALFX_FLAGS(a0)
+  subq.w   #1, palfx_running
+  bra      3f
+2:lsr.w    #8, d0
+  lsr.w    #5, d0                  // 0x10000 / PALFX_LEVELS
+3:cmp.b    PALFX_LEVEL(a0), d0
+  beq      8f
+  move.b   d0, PALFX_LEVEL(a0)
+
+  // blend each entry at the new level
+  lsl.w    #6, d0
+  lea      palfx_blend, a2
+  adda.w   d0, a2
+  movea.l  PALFX_TO(a0), a1
+  lea      PALFX_FROM(a0), a4
+  moveq    #0, d7
+  move.b   PALFX_FIRST(a0), d7
+  lea      palfx_pal, a3
+  move.w   d7, d0
+  add.w    d0, d0
+  adda.w   d0, a3
+  moveq    #0, d6
+  move.b   PALFX_COUNT(a0), d6
+  subq.w   #1, d6
+  bcs      8f
+
+4:move.w   (a4)+, d0
+  move.w   PALFX_COLOR(a0), d1
+  move.l   a1, d5
+  beq      5f
+  move.w   (a1)+, d1
+
+5:moveq    #0xE, d2                // red
+  and.w    d0, d2
+  lsl.w    #2, d2
+  moveq    #0xE, d3
+  and.w    d1, d3
+  lsr.w    #1, d3
+  or.w     d3, d2
+  moveq    #0, d4
+  move.b   (a2,d2.w), d4
+
+  move.w   d0, d2                  // green
+  lsr.w    #2, d2
+  andi.w   #0x38, d2
+  move.w   d1, d3
+  lsr.w    #5, d3
+  andi.w   #7, d3
+  or.w     d3, d2
+  moveq    #0, d5
+  move.b   (a2,d2.w), d5
+  lsl.w    #4, d5
+  or.w     d5, d4
+
+  move.w   d0, d2                  // blue
+  lsr.w    #6, d2
+  andi.w   #0x38, d2
+  move.w   d1, d3
+  lsr.w    #8, d3
+  lsr.w    #1, d3
+  andi.w   #7, d3
+  or.w     d3, d2
+  moveq    #0, d5
+  move.b   (a2,d2.w), d5
+  lsl.w    #8, d5
+  or.w     d5, d4
+
+  bsr      palfx_store
+  addq.l   #2, a3
+  addq.w   #1, d7
+  dbf      d6, 4b
+
+8:lea      PALFX_SIZE(a0), a0
+  subq.w   #1, (sp)
+  bcc      1b
+  addq.l   #2, sp
+  POPM     d2-d7/a2-a5
+  rts
+
+/**
+ * @brief Write a color to the working palette and mark it if it changed
+ * @param[in] A3.l Entry in palfx_pal
+ * @param[in] A5.l palfx_dirty
+ * @param[in] D4.w Color
+ * @param[in] D7.w Entry index
+ * @clobber d2
+ */
+palfx_store:
+  cmp.w    (a3), d4
+  beq      9f
+  move.w   d4, (a3)
+  move.w   d7, d2
+  lsr.w    #3, d2
+  andi.w   #0xFE, d2               // span of the palette line
+  cmp.b    (a5,d2.w), d7
+  bcc      1f
+  move.b   d7, (a5,d2.w)
+1:cmp.b    1(a5,d2.w), d7
+  bls      9f
+  move.b   d7, 1(a5,d2.w)
+9:rts
+
+/**
+ * @fn palfx_flush
+ * @brief Queue the changed entries of the working palette for DMA
+ * @clobber d0-d1/a0-a1
+ * @details Each palette line with changes is sent as one transfer, from its
+ * first changed entry to its last. Lines which did not fit in the DMA queue
+ * are tried again on the next flush.
+ */
+SUB palfx_flush
+  PUSHM    d2-d4/a2
+  lea      palfx_dirty, a2
+  moveq    #4 - 1, d4
+1:moveq    #0, d0
+  move.b   (a2), d0                // first
+  moveq    #0, d2
+  move.b   1(a2), d2               // last
+  cmp.w    d2, d0
+  bhi      2f
+  sub.w    d0, d2
+  addq.w   #1, d2
+  add.w    d0, d0
+  move.l   #palfx_pal, d1
+  add.l    d0, d1
+  TO_VDPPTR d0
+  ori.l    #CRAM_W, d0
+  move.w   #PALFX_DMA_PRIORITY, d3
+  jsr      dmaq_push
+  bcs      2f
+  move.w   #0xFF00, (a2)
+2:addq.l   #2, a2
+  dbf      d4, 1b
+  POPM     d2-d4/a2
+  rts
+
+.section .bss
+
+.global palfx_rate
+palfx_rate: .long 0
+
+.global palfx_slots
+palfx_slots: .space PALFX_SLOTS * PALFX_SIZE
+
+.global palfx_pal
+palfx_pal: .space 64 * 2
+
+.global palfx_dirty
+palfx_dirty: .space 4 * 2
+
+.global palfx_running
+palfx_running: .word 0
+
+.global palfx_blend
+palfx_blend: .space (PALFX_LEVELS + 1) * 64
+
+.align 2
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/raster.def.h
+ * @brief Raster effect scheduler definitions
+ *
+ * @details
+ * A line table is a list of steps. The first step is run from VBlank and
+ * each of the others from an HBlank interrupt:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | word | HBlank counter register write (VDP_REG_HBLANK_COUNT)
+ * 0x02   | word | Number of commands, minus 1 (-1 for none)
+ * 0x04   | ...  | Commands
+ *
+ * A command is a single word for a register write, or a vdp_cmd (two words)
+ * followed by the word to write to the data port. They are told apart by bit
+ * 14 of the first word, which is clear only for register writes.
+ *
+ * The VDP reloads its HBlank counter when the interrupt is raised, before the
+ * handler can change it, so the counter written by each step sets the time
+ * from the next interrupt to the one after it. The first two interrupts of a
+ * frame are always at lines 0 and 1 as a result.
+ */
+
+#ifndef MEGADEV__MAIN_RASTER_DEF_H
+#define MEGADEV__MAIN_RASTER_DEF_H
+
+#define RASTER_NEXT     0x00
+#define RASTER_COUNT    0x02
+#define RASTER_COMMANDS 0x04
+
+/**
+ * @def RASTER_TABLE_SIZE
+ * @brief Size of each of the two line tables in bytes
+ */
+#ifndef RASTER_TABLE_SIZE
+#define RASTER_TABLE_SIZE 1024
+#endif
+
+/**
+ * @def RASTER_NO_HBLANK
+ * @brief HBlank counter register write which puts the next interrupt past
+ * the end of the frame
+ */
+#define RASTER_NO_HBLANK 0x8AFF
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/raster.h
+ * @brief Raster effect scheduler
+ *
+ * @details
+ * Changes VDP registers, colors and scroll values partway down the screen
+ * from the HBlank interrupt. Each frame, a line table is built with the
+ * changes for each line; the table is switched in at the next VBlank, while
+ * the one on display keeps running, so it can be built at any time during
+ * the frame.
+ *
+ *   raster_init_c();
+ *   bios_set_hblank_workram(raster_hblank);
+ *   // and enable VDP_HBLANK_ENABLE in register 0
+ *
+ *   // each frame
+ *   raster_begin_c();
+ *   raster_color_c(0, 0, 0x200);   // VBlank step: colors for the top
+ *   raster_color_c(120, 0, 0xE80); // water line
+ *   raster_reg_c(120, VDP_REG_BGCOLOR | 0x10);
+ *   raster_end_c();
+ *
+ *   // in the VBlank handler
+ *   raster_vblank_c();
+ *
+ * Lines must be added in order. Changes for line 0 are made from VBlank, and
+ * these should set back anything changed further down the screen. Since the
+ * HBlank handler may run at any point during active display, the rest of the
+ * program should not use the VDP ports outside VBlank while a table is
+ * running. The handler is in Work RAM, so it is installed with
+ * bios_set_hblank_workram.
+ *
+ * Be sure to include raster_main.s in your module when using these.
+ */
+
+#ifndef MEGADEV__MAIN_RASTER_H
+#define MEGADEV__MAIN_RASTER_H
+
+#include "main/raster.def.h"
+#include "main/vdp.h"
+#include "types.h"
+
+/**
+ * @fn raster_hblank
+ * @brief HBlank interrupt handler
+ */
+extern void raster_hblank();
+
+/**
+ * @fn raster_init_c
+ * @brief Set up the scheduler with empty line tables
+ */
+static inline void raster_init_c()
+{
+  asm volatile(
+    "\
+  jsr raster_init \n\
+		"
+    :
+    :
+    : "a0", "cc", "memory");
+}
+
+/**
+ * @fn raster_begin_c
+ * @brief Start building the line table for the next frame
+ */
+static inline void raster_begin_c()
+{
+  asm volatile(
+    "\
+  jsr raster_begin \n\
+		"
+    :
+    :
+    : "a0", "cc", "memory");
+}
+
+/**
+ * @fn raster_reg_c
+ * @brief Add a register write to the line table
+ * @param line Line (0 for the VBlank step)
+ * @param reg Register write, e.g. VDP_REG_BGCOLOR | 0x0F
+ * @return false if the line is before the last one added, or the table is
+ * full
+ */
+static inline bool raster_reg_c(u16 line, vdp_reg reg)
+{
+  register u16 d0_line asm("d0") = line;
+  register u16 d1_reg asm("d1") = reg;
+  register u8  result;
+
+  asm volatile(
+    "\
+  jsr raster_reg \n\
+  scc %[result] \n\
+		"
+    : "+d"(d0_line), "+d"(d1_reg), [result] "=d"(result)
+    :
+    : "a0", "a1", "cc", "memory");
+
+  return result;
+}
+
+/**
+ * @fn raster_write_c
+ * @brief Add a write to VRAM, CRAM or VSRAM to the line table
+ * @param line Line (0 for the VBlank step)
+ * @param dest Destination address (in vdp_cmd format)
+ * @param value Word to write
+ * @return false if the line is before the last one added, or the table is
+ * full
+ */
+static inline bool raster_write_c(u16 line, vdp_cmd dest, u16 value)
+{
+  register u16 d0_line asm("d0") = line;
+  register u32 d1_dest asm("d1") = dest;
+  register u16 d2_value asm("d2") = value;
+  register u8  result;
+
+  asm volatile(
+    "\
+  jsr raster_write \n\
+  scc %[result] \n\
+		"
+    : "+d"(d0_line), "+d"(d1_dest), [result] "=d"(result)
+    : "d"(d2_value)
+    : "a0", "a1", "cc", "memory");
+
+  return result;
+}
+
+/**
+ * @fn raster_color_c
+ * @brief Add a palette change to the line table
+ * @param line Line (0 for the VBlank step)
+ * @param index Palette entry (0 to 63)
+ * @param color Color
+ * @return false if the line is before the last one added, or the table is
+ * full
+ */
+static inline bool raster_color_c(u16 line, u16 index, u16 color)
+{
+  return raster_write_c(line, to_vdp_addr(index << 1) | CRAM_W, color);
+}
+
+/**
+ * @fn raster_vscroll_c
+ * @brief Add a vertical scroll change to the line table
+ * @param line Line (0 for the VBlank step)
+ * @param index VSRAM entry (0 for plane A, 1 for plane B, in full screen
+ * vertical scroll mode)
+ * @param value Scroll value
+ * @return false if the line is before the last one added, or the table is
+ * full
+ */
+static inline bool raster_vscroll_c(u16 line, u16 index, u16 value)
+{
+  return raster_write_c(line, to_vdp_addr(index << 1) | VSRAM_W, value);
+}
+
+/**
+ * @fn raster_hscroll_c
+ * @brief Add a horizontal scroll change to the line table
+ * @param line Line (0 for the VBlank step)
+ * @param addr Address of the entry in the HScroll table
+ * @param value Scroll value
+ * @return false if the line is before the last one added, or the table is
+ * full
+ */
+static inline bool raster_hscroll_c(u16 line, vram_addr addr, u16 value)
+{
+  return raster_write_c(line, to_vdp_addr(addr) | VRAM_W, value);
+}
+
+/**
+ * @fn raster_end_c
+ * @brief Finish the line table, to be shown from the next VBlank
+ */
+static inline void raster_end_c()
+{
+  asm volatile(
+    "\
+  jsr raster_end \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+/**
+ * @fn raster_vblank_c
+ * @brief Start the line table for the next frame
+ * @note Call from the VBlank handler
+ */
+static inline void raster_vblank_c()
+{
+  asm volatile(
+    "\
+  jsr raster_vblank \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+#endif
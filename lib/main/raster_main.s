@@ -0,0 +1,270 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/raster_main.s
+ * @brief Raster effect scheduler
+ *
+ * @details
+ * See raster.def.h for the line table format and main/raster.h for usage.
+ */
+
+#ifndef MEGADEV__MAIN_RASTER_S
+#define MEGADEV__MAIN_RASTER_S
+
+#include <macros.s>
+#include <main/raster.def.h>
+#include <main/vdp.def.h>
+
+/**
+ * @brief Run one step of the line table
+ * @param[in] A0.l Step
+ * @param[out] A0.l Next step
+ * @clobber d0-d1/a1-a2
+ */
+.macro RASTER_RUN
+  lea      (VDP_CTRL).l, a1
+  lea      (VDP_DATA).l, a2
+  move.w   (a0)+, (a1)
+  move.w   (a0)+, d0
+  bmi      3f
+1:move.w   (a0)+, d1
+  move.w   d1, (a1)
+  btst     #14, d1
+  beq      2f
+  move.w   (a0)+, (a1)
+  move.w   (a0)+, (a2)
+2:dbf      d0, 1b
+3:
+.endm
+
+.section .text
+
+/**
+ * @fn raster_hblank
+ * @brief HBlank interrupt handler
+ * @details Runs the next step of the line table on display. Install it with
+ * bios_set_hblank_workram.
+ */
+SUB raster_hblank
+  PUSHM    d0-d1/a0-a2
+  movea.l  raster_ptr, a0
+  RASTER_RUN
+  move.l   a0, raster_ptr
+  POPM     d0-d1/a0-a2
+  rte
+
+/**
+ * @fn raster_vblank
+ * @brief Start the line table for the next frame
+ * @clobber d0-d1/a0-a1
+ * @details Meant to be called from the VBlank handler. Switches to the table
+ * finished with raster_end, if there is one, and runs its VBlank step.
+ */
+SUB raster_vblank
+  PUSHM    a2
+  tst.b    raster_ready
+  beq      1f
+  move.l   raster_front, d0
+  move.l   raster_back, raster_front
+  move.l   d0, raster_back
+  clr.b    raster_ready
+1:movea.l  raster_front, a0
+  RASTER_RUN
+  move.l   a0, raster_ptr
+  POPM     a2
+  rts
+
+/**
+ * @fn raster_init
+ * @brief Set up the scheduler with empty line tables
+ * @clobber a0
+ */
+SUB raster_init
+  lea      raster_tables, a0
+  move.l   a0, raster_front
+  move.l   a0, raster_ptr
+  move.l   #(RASTER_NO_HBLANK << 16) | 0xFFFF, (a0)
+  lea      RASTER_TABLE_SIZE(a0), a0
+  move.l   a0, raster_back
+  move.l   #(RASTER_NO_HBLANK << 16) | 0xFFFF, (a0)
+  clr.b    raster_ready
+  rts
+
+/**
+ * @fn raster_begin
+ * @brief Start building the line table for the next frame
+ * @clobber a0
+ * @details The table on display is not touched. A table which was finished
+ * but not yet picked up by raster_vblank is dropped.
+ */
+SUB raster_begin
+  clr.b    raster_ready
+  movea.l  raster_back, a0
+  move.l   a0, raster_prev1
+  clr.l    raster_prev2
+  move.l   #(RASTER_NO_HBLANK << 16) | 0xFFFF, (a0)+
+  move.l   a0, raster_wp
+  subq.l   #2, a0
+  move.l   a0, raster_step
+  move.w   #-1, raster_line
+  clr.w    raster_steps
+  rts
+
+/**
+ * @fn raster_reg
+ * @brief Add a register write to the line table
+ * @param[in] D0.w Line (0 for the VBlank step)
+ * @param[in] D1.w Register write, e.g. VDP_REG_BGCOLOR | 0x0F
+ * @param[out] CC Added
+ * @param[out] CS The line is before the last one added, or the table is full
+ * @clobber d0-d1/a0-a1
+ */
+SUB raster_reg
+  PUSHM    d1
+  bsr      raster_open
+  POPM     d1
+  bcs      9f
+  movea.l  raster_wp, a0
+  move.w   d1, (a0)+
+  move.l   a0, raster_wp
+  movea.l  raster_step, a0
+  addq.w   #1, (a0)
+  move     #0, ccr
+9:rts
+
+/**
+ * @fn raster_write
+ * @brief Add a write to VRAM, CRAM or VSRAM to the line table
+ * @param[in] D0.w Line (0 for the VBlank step)
+ * @param[in] D1.l Destination address (in vdp_cmd format)
+ * @param[in] D2.w Word to write
+ * @param[out] CC Added
+ * @param[out] CS The line is before the last one added, or the table is full
+ * @clobber d0-d1/a0-a1
+ */
+SUB raster_write
+  PUSHM    d1
+  bsr      raster_open
+  POPM     d1
+  bcs      9f
+  movea.l  raster_wp, a0
+  move.l   d1, (a0)+
+  move.w   d2, (a0)+
+  move.l   a0, raster_wp
+  movea.l  raster_step, a0
+  addq.w   #1, (a0)
+  move     #0, ccr
+9:rts
+
+/**
+ * @fn raster_end
+ * @brief Finish the line table, to be shown from the next VBlank
+ * @clobber d0-d1/a0-a1
+ */
+SUB raster_end
+  // there is always an interrupt at line 1 after the one at line 0
+  // (which has room kept for it)
+  cmpi.w   #1, raster_steps
+  bne      1f
+  movea.l  raster_wp, a0
+  moveq    #2, d0
+  bsr      raster_open_line
+1:move.b   #1, raster_ready
+  rts
+
+/**
+ * @brief Make the step for a line the current one
+ * @param[in] D0.w Line
+ * @param[out] CS The line is before the current step, or the table is full
+ * @clobber d0-d1/a0-a1
+ */
+raster_open:
+  // room for a command and up to three new steps, plus the one raster_end
+  // may add
+  movea.l  raster_wp, a0
+  movea.l  raster_back, a1
+  lea      (RASTER_TABLE_SIZE - 6 - 4 * 4, a1), a1
+  cmpa.l   a1, a0
+  bhi      9f
+
+raster_open_line:
+  subq.w   #1, d0                  // interrupt at the end of the line before
+  cmp.w    raster_line, d0
+  beq      8f
+  blt      9f
+
+  // the first two interrupts are at lines 0 and 1
+1:move.w   raster_steps, d1
+  beq      2f
+  subq.w   #1, d1
+  beq      3f
+  move.w   d0, d1
+
+  // the step two before sets the time from the last step to this one
+  movea.l  raster_prev2, a1
+  move.w   d1, -(sp)
+  sub.w    raster_line, d1
+  subq.w   #1, d1
+  ori.w    #VDP_REG_HBLANK_COUNT, d1
+  move.w   d1, (a1)
+  move.w   (sp)+, d1
+  bra      4f
+2:movea.l  raster_prev1, a1
+  move.w   #VDP_REG_HBLANK_COUNT, (a1)
+  bra      4f
+3:moveq    #1, d1
+
+4:move.l   raster_prev1, raster_prev2
+  move.l   a0, raster_prev1
+  move.l   #(RASTER_NO_HBLANK << 16) | 0xFFFF, (a0)+
+  lea      -2(a0), a1
+  move.l   a1, raster_step
+  move.w   d1, raster_line
+  addq.w   #1, raster_steps
+  cmp.w    d1, d0
+  bne      1b
+  move.l   a0, raster_wp
+
+8:move     #0, ccr
+  rts
+9:move     #1, ccr
+  rts
+
+.section .bss
+
+.global raster_ptr
+raster_ptr: .long 0
+
+.global raster_front
+raster_front: .long 0
+
+.global raster_back
+raster_back: .long 0
+
+.global raster_wp
+raster_wp: .long 0
+
+.global raster_step
+raster_step: .long 0
+
+.global raster_prev1
+raster_prev1: .long 0
+
+.global raster_prev2
+raster_prev2: .long 0
+
+.global raster_line
+raster_line: .word 0
+
+.global raster_steps
+raster_steps: .word 0
+
+.global raster_tables
+raster_tables: .space RASTER_TABLE_SIZE * 2
+
+.global raster_ready
+raster_ready: .byte 0
+
+.align 2
+
+#endif
@@ -0,0 +1,226 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/rpc.h
+ * @brief Non-blocking requests to the Sub CPU over the comm registers
+ *
+ * @details
+ * This replaces the usual blocking handshake (set COMCMD0, wait for COMSTAT0,
+ * clear COMCMD0, wait for COMSTAT0 to clear). A request is sent with
+ * @ref rpc_send_c, which returns immediately, and its completion is checked
+ * with @ref rpc_poll_c, so the Main CPU can continue rendering while the Sub
+ * CPU works. Only one request may be outstanding at a time.
+ *
+ * The Sub CPU side must be using sub/rpc.h. See rpc.def.h for the details of
+ * the protocol.
+ *
+ * Define RPC_LATENCY to keep round trip times per command in
+ * @ref rpc_latency (see rpc.def.h).
+ *
+ * Be sure to include rpc_main.s in your module when using these.
+ */
+
+#ifndef MEGADEV__MAIN_RPC_H
+#define MEGADEV__MAIN_RPC_H
+
+#include "rpc.def.h"
+#include "types.h"
+#ifdef RPC_LATENCY
+#include "main/bios.h"
+#include "str_util.h"
+#endif
+
+/**
+ * @var rpc_pending
+ * @brief Non-zero while a request is outstanding
+ */
+extern volatile u8 rpc_pending;
+
+/**
+ * @fn rpc_init_c
+ * @brief Reset the Main side of the RPC channel
+ */
+static inline void rpc_init_c()
+{
+  asm volatile(
+    "\
+  jsr rpc_init \n\
+		"
+    :
+    :
+    : "d0", "a0", "cc", "memory");
+}
+
+/**
+ * @fn rpc_send_c
+ * @brief Send a request to the Sub CPU without waiting for it to complete
+ * @param command Command ID (the index into the Sub CPU dispatch table)
+ * @param params Pointer to RPC_PARAM_COUNT parameter words, or NULL
+ * @return Sequence number of the request, or 0 if a previous request is still
+ * outstanding (in which case nothing was sent)
+ */
+static inline u8 rpc_send_c(u8 command, u16 const * params)
+{
+  register u8  d0_cmd asm("d0") = command;
+  register u32 a0_params asm("a0") = (u32) params;
+
+  asm volatile(
+    "\
+  jsr rpc_send \n\
+		"
+    : "+d"(d0_cmd), "+a"(a0_params)
+    :
+    : "d1", "a1", "cc", "memory");
+
+  return d0_cmd;
+}
+
+/**
+ * @fn rpc_poll_c
+ * @brief Check if the outstanding request has been completed
+ * @param results Pointer to RPC_PARAM_COUNT words to receive the response, or
+ * NULL
+ * @return The status returned by the Sub CPU handler, RPC_STATUS_PENDING if
+ * the request has not yet completed, or RPC_STATUS_IDLE if there is no
+ * outstanding request
+ */
+static inline u8 rpc_poll_c(u16 * results)
+{
+  register u8  d0_status asm("d0");
+  register u32 a0_results asm("a0") = (u32) results;
+
+  asm volatile(
+    "\
+  jsr rpc_poll \n\
+		"
+    : "=d"(d0_status), "+a"(a0_results)
+    :
+    : "d1", "a1", "cc", "memory");
+
+  return d0_status;
+}
+
+/**
+ * @fn rpc_busy
+ * @brief Check if a request is outstanding
+ */
+static inline bool rpc_busy()
+{
+  return rpc_pending != 0;
+}
+
+/**
+ * @fn rpc_call
+ * @brief Send a request and wait for it to complete
+ * @return The status returned by the Sub CPU handler
+ * @note This is the blocking equivalent of the older handshake, for code that
+ * has nothing else to do while waiting
+ */
+static inline u8 rpc_call(u8 command, u16 const * params, u16 * results)
+{
+  u8 status;
+
+  while (rpc_send_c(command, params) == 0)
+    rpc_poll_c(NULL);
+
+  do
+    status = rpc_poll_c(results);
+  while (status == RPC_STATUS_PENDING);
+
+  return status;
+}
+
+#ifdef RPC_LATENCY
+
+/**
+ * @struct RpcLatency
+ * @brief Latency measurements for a single command ID
+ */
+typedef struct RpcLatency
+{
+  /**
+   * @brief Number of completed requests
+   * @details Measurement stops if this reaches 0xFFFF
+   */
+  u16 count;
+  /**
+   * @brief Shortest round trip
+   */
+  u16 min;
+  /**
+   * @brief Longest round trip
+   */
+  u16 max;
+  /**
+   * @brief Sum of all round trips
+   */
+  u32 total;
+} RpcLatency;
+
+/**
+ * @var rpc_latency
+ * @brief Round trip times, indexed by command ID
+ * @details Times are in scanlines, from rpc_send_c to the response being seen
+ * by rpc_poll_c, so they include the delay in polling as well. Timestamps are
+ * based on the Boot ROM VBlank counter, unless RPC_LATENCY_FRAMES is defined
+ * as the address of another frame counter.
+ * @note Cleared by rpc_init_c
+ */
+extern volatile RpcLatency rpc_latency[RPC_LATENCY_COMMANDS];
+
+/**
+ * @fn rpc_latency_avg
+ * @brief Average round trip time for a command
+ */
+static inline u16 rpc_latency_avg(u8 command)
+{
+  register u32 total = rpc_latency[command].total;
+  u16 count = rpc_latency[command].count;
+
+  if (count == 0)
+    return 0;
+
+  // the quotient is no larger than max, so it always fits in a word
+  asm("divu.w %1, %0" : "+d"(total) : "d"(count) : "cc");
+  return total;
+}
+
+/**
+ * @fn rpc_latency_print
+ * @brief Display the latency table as a debug overlay
+ * @param pos Position of the heading as a VRAM write command (vdp_cmd)
+ * @param pitch Size of one row of the plane, in bytes
+ * @details Shows one line per measured command, with the ID, count and the
+ * minimum, average and maximum round trip in hex. Uses the Boot ROM font,
+ * which must already be loaded.
+ */
+static inline void rpc_latency_print(vdp_cmd pos, u16 pitch)
+{
+  char line[24];
+
+  bios_print("ID CNT  MIN  AVG  MAX\xff", pos);
+
+  for (u16 i = 0; i < RPC_LATENCY_COMMANDS; ++i)
+  {
+    volatile RpcLatency * entry = &rpc_latency[i];
+    if (entry->count == 0)
+      continue;
+
+    pos += (u32) pitch << 16;
+    hextoa8(i, line);
+    line[2] = ' ';
+    hextoa16(entry->count, line + 3);
+    line[7] = ' ';
+    hextoa16(entry->min, line + 8);
+    line[12] = ' ';
+    hextoa16(rpc_latency_avg(i), line + 13);
+    line[17] = ' ';
+    hextoa16(entry->max, line + 18);
+    line[22] = 0xff;
+    bios_print(line, pos);
+  }
+}
+
+#endif
+
+#endif
@@ -0,0 +1,234 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/rpc_main.s
+ * @brief Non-blocking requests to the Sub CPU over the comm registers
+ *
+ * @details
+ * See rpc.def.h for the protocol and main/rpc.h for usage.
+ */
+
+#ifndef MEGADEV__MAIN_RPC_S
+#define MEGADEV__MAIN_RPC_S
+
+#include <macros.s>
+#include <rpc.def.h>
+#include <main/gate_arr.def.h>
+#ifdef RPC_LATENCY
+#include <main/bios.def.h>
+#include <main/vdp.def.h>
+
+/*
+ * The frame counter must be incremented once per VBlank; by default this is
+ * the counter kept by the Boot ROM VBlank handler
+ */
+#ifndef RPC_LATENCY_FRAMES
+#define RPC_LATENCY_FRAMES BIOS_VBLANK_COUNTER
+#endif
+
+// The V counter value at which VBlank begins (0xF0 in V30 mode)
+#ifndef RPC_LATENCY_VBLANK_LINE
+#define RPC_LATENCY_VBLANK_LINE 0xE0
+#endif
+#endif
+
+.section .text
+
+/**
+ * @fn rpc_init
+ * @brief Reset the Main side of the RPC channel
+ * @clobber d0/a0
+ * @details The sequence number continues from the last one reported by the
+ * Sub CPU, so a stale response from before the reset cannot be mistaken for
+ * the response to the first new request.
+ */
+SUB rpc_init
+  clr.w    GA_REG_COMCMD0
+  move.b   GA_REG_COMSTAT0, d0
+  move.b   d0, rpc_seq
+  sf       rpc_pending
+#ifdef RPC_LATENCY
+  lea      rpc_latency, a0
+  move.w   #(RPC_LATENCY_COMMANDS * RPC_LATENCY_SIZE / 2) - 1, d0
+0:clr.w    (a0)+
+  dbf      d0, 0b
+#endif
+  rts
+
+/**
+ * @fn rpc_send
+ * @brief Send a request to the Sub CPU without waiting for it to complete
+ * @param[in] D0.b Command
+ * @param[in] A0.l Pointer to RPC_PARAM_COUNT parameter words (0 for none)
+ * @param[out] D0.b Sequence number of the request (0 if not sent)
+ * @param[out] CC Request sent
+ * @param[out] CS A previous request is still outstanding; nothing was sent
+ * @clobber d1/a0-a1
+ */
+SUB rpc_send
+  tst.b    rpc_pending
+  bne      9f
+  move.l   a0, d1
+  beq      1f
+  // parameters must be in place before COMCMD0 changes
+  lea      GA_REG_COMCMD1, a1
+  move.l   (a0)+, (a1)+
+  move.l   (a0)+, (a1)+
+  move.l   (a0)+, (a1)+
+  move.w   (a0)+, (a1)+
+1:moveq    #0, d1
+  move.b   rpc_seq, d1
+  addq.b   #1, d1
+  bne      2f
+  moveq    #1, d1       // sequence number 0 is reserved for idle
+2:move.b   d1, rpc_seq
+  lsl.w    #8, d1
+  move.b   d0, d1
+#ifdef RPC_LATENCY
+  move.b   d0, rpc_lat_cmd
+  move.w   d1, -(sp)
+  bsr      rpc_timestamp
+  move.w   d0, rpc_lat_start
+  move.w   (sp)+, d1
+#endif
+  st       rpc_pending
+  move.w   d1, GA_REG_COMCMD0
+  lsr.w    #8, d1
+  move.b   d1, d0
+  rts
+9:moveq    #0, d0
+  move     #1, ccr
+  rts
+
+/**
+ * @fn rpc_poll
+ * @brief Check if the outstanding request has been completed
+ * @param[in] A0.l Pointer to RPC_PARAM_COUNT words for the response (0 to
+ * ignore the response)
+ * @param[out] D0.b Status (RPC_STATUS_PENDING if not yet complete,
+ * RPC_STATUS_IDLE if there is no outstanding request)
+ * @param[out] CC Request complete (or none outstanding)
+ * @param[out] CS Request still pending
+ * @clobber d1/a0-a1
+ */
+SUB rpc_poll
+  tst.b    rpc_pending
+  beq      8f
+  move.w   GA_REG_COMSTAT0, d0
+  move.w   d0, d1
+  lsr.w    #8, d1
+  cmp.b    rpc_seq, d1
+  bne      9f
+  cmpi.b   #RPC_STATUS_PENDING, d0
+  beq      9f
+  move.l   a0, d1
+  beq      1f
+  lea      GA_REG_COMSTAT1, a1
+  move.l   (a1)+, (a0)+
+  move.l   (a1)+, (a0)+
+  move.l   (a1)+, (a0)+
+  move.w   (a1)+, (a0)+
+1:sf       rpc_pending
+#ifdef RPC_LATENCY
+  move.w   d0, -(sp)
+  bsr      rpc_timestamp
+  sub.w    rpc_lat_start, d0
+  move.w   d0, d1
+  moveq    #0, d0
+  move.b   rpc_lat_cmd, d0
+  lea      rpc_latency, a0
+  bsr      rpc_latency_add
+  move.w   (sp)+, d0
+#endif
+  andi.w   #0xFF, d0
+  rts
+8:move.w   #RPC_STATUS_IDLE, d0
+  rts
+9:move.w   #RPC_STATUS_PENDING, d0
+  move     #1, ccr
+  rts
+
+#ifdef RPC_LATENCY
+/**
+ * @fn rpc_timestamp
+ * @brief Current time for latency measurement
+ * @param[out] D0.w Frame count (upper byte) and V counter relative to the
+ * start of VBlank (lower byte)
+ * @clobber d1
+ * @details The difference between two timestamps is the elapsed time in
+ * scanlines, give or take the few lines lost during VBlank, for up to 256
+ * frames. The timestamp never goes back: the frame count is only advanced by
+ * the VBlank handler a few lines after the V counter passes the VBlank line,
+ * and the NTSC V counter jumps back within VBlank, so a value up to 255
+ * lines before the last one returned is held at the last one.
+ */
+rpc_timestamp:
+0:move.b   RPC_LATENCY_FRAMES, d1
+  move.b   VDP_HVCOUNTER, d0
+  cmp.b    RPC_LATENCY_FRAMES, d1
+  bne      0b           // VBlank occurred between the reads
+  subi.b   #RPC_LATENCY_VBLANK_LINE, d0
+  lsl.w    #8, d1
+  move.b   d0, d1
+  move.w   d1, d0
+  sub.w    rpc_lat_last, d1
+  cmpi.w   #-0xFF, d1
+  bcs      1f
+  move.w   rpc_lat_last, d0
+1:move.w   d0, rpc_lat_last
+  rts
+
+/**
+ * @fn rpc_latency_add
+ * @brief Add a sample to the latency table
+ * @param[in] A0.l Pointer to the latency table
+ * @param[in] D0.w Command ID
+ * @param[in] D1.w Latency
+ * @clobber d0/a0
+ */
+rpc_latency_add:
+  cmpi.w   #RPC_LATENCY_COMMANDS, d0
+  bcc      9f
+  mulu.w   #RPC_LATENCY_SIZE, d0
+  adda.w   d0, a0
+  cmpi.w   #0xFFFF, RPC_LATENCY_COUNT(a0)
+  beq      9f           // full; stop so that the average stays valid
+  tst.w    RPC_LATENCY_COUNT(a0)
+  beq      1f
+  cmp.w    RPC_LATENCY_MIN(a0), d1
+  bcc      2f
+1:move.w   d1, RPC_LATENCY_MIN(a0)
+2:cmp.w    RPC_LATENCY_MAX(a0), d1
+  bls      3f
+  move.w   d1, RPC_LATENCY_MAX(a0)
+3:addq.w   #1, RPC_LATENCY_COUNT(a0)
+  moveq    #0, d0
+  move.w   d1, d0
+  add.l    d0, RPC_LATENCY_TOTAL(a0)
+9:rts
+#endif
+
+.section .bss
+
+.global rpc_seq
+rpc_seq: .byte 0
+
+.global rpc_pending
+rpc_pending: .byte 0
+
+.align 2
+
+#ifdef RPC_LATENCY
+.global rpc_latency
+rpc_latency: .space RPC_LATENCY_COMMANDS * RPC_LATENCY_SIZE
+
+rpc_lat_start: .word 0
+
+rpc_lat_last: .word 0
+
+rpc_lat_cmd: .byte 0
+
+.align 2
+#endif
+
+#endif
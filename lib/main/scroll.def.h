@@ -0,0 +1,61 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/scroll.def.h
+ * @brief Scroll table builder definitions
+ *
+ * @details
+ * The scroll tables are built from a list of bands, each in this format:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | word | First line (HScroll) or 2 cell column (VScroll)
+ * 0x02   | word | Number of lines or columns
+ * 0x04   | word | Scroll factor (8.8 fixed point, signed)
+ * 0x06   | word | Change to the factor per line (8.8 fixed point, signed)
+ * 0x08   | byte | Plane (0 for A, 1 for B)
+ * 0x09   | byte | Wobble amplitude in pixels (0 for none)
+ * 0x0A   | byte | Wobble phase step per line (256 is a full wave)
+ * 0x0B   | byte | Wobble phase step per frame
+ *
+ * The list ends with a first line of SCROLL_END.
+ */
+
+#ifndef MEGADEV__MAIN_SCROLL_DEF_H
+#define MEGADEV__MAIN_SCROLL_DEF_H
+
+#define SCROLL_FIRST     0x00
+#define SCROLL_COUNT     0x02
+#define SCROLL_FACTOR    0x04
+#define SCROLL_SLOPE     0x06
+#define SCROLL_PLANE     0x08
+#define SCROLL_AMP       0x09
+#define SCROLL_FREQ      0x0A
+#define SCROLL_SPEED     0x0B
+#define SCROLL_BAND_SIZE 0x0C
+
+#define SCROLL_END 0xFFFF
+
+/**
+ * @def SCROLL_LINES
+ * @brief Number of lines in the HScroll table
+ * @details Only the lines on screen are built and sent, which is 224 unless
+ * the V30 mode is enabled.
+ */
+#define SCROLL_LINES 240
+
+/**
+ * @def SCROLL_COLUMNS
+ * @brief Number of 2 cell columns in VSRAM
+ */
+#define SCROLL_COLUMNS 20
+
+/**
+ * @def SCROLL_DMA_PRIORITY
+ * @brief Priority of the scroll tables in the DMA queue
+ */
+#ifndef SCROLL_DMA_PRIORITY
+#define SCROLL_DMA_PRIORITY 0
+#endif
+
+#endif
@@ -0,0 +1,170 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/scroll.h
+ * @brief Scroll table builder
+ *
+ * @details
+ * Builds the HScroll table (for line or cell scroll mode) and VSRAM (for 2
+ * cell column scroll mode) from short lists of bands, and sends them through
+ * the DMA queue (see main/dmaq.h). Each band scrolls a range of lines at a
+ * fraction of a position, which may change down the band for a perspective
+ * effect, plus an optional sine wave for heat haze or water.
+ *
+ *   ScrollBand const bands[] = {
+ *     // sky and far hills, plane B
+ *     {.first = 0, .count = 64, .factor = 0x0020, .plane = 1},
+ *     {.first = 64, .count = 64, .factor = 0x0080, .plane = 1},
+ *     // water, getting faster toward the bottom, with a ripple
+ *     {.first = 128, .count = 96, .factor = 0x0080, .slope = 0x0002,
+ *      .plane = 1, .amp = 2, .freq = 16, .speed = 4},
+ *     // foreground, plane A
+ *     {.first = 0, .count = 224, .factor = 0x0100},
+ *     {.first = SCROLL_END}};
+ *
+ *   scroll_init_c(vdpreg_get(VDP_REG_MODE2), 0xFC00);
+ *
+ *   // each frame
+ *   scroll_hbuild_c(bands, -camera_x, frame);
+ *   scroll_flush_c();
+ *
+ * The factor is 8.8 fixed point, so 0x0100 scrolls by the position itself.
+ * Bands with neither a slope nor a wobble are a single store per line. In
+ * cell scroll mode, only the first line of each cell is used by the VDP, and
+ * in full screen mode only line 0 (or column 0).
+ *
+ * Be sure to include scroll_main.s, dmaq_main.s and vdp.s in your module when
+ * using these.
+ */
+
+#ifndef MEGADEV__MAIN_SCROLL_H
+#define MEGADEV__MAIN_SCROLL_H
+
+#include "main/scroll.def.h"
+#include "types.h"
+
+/**
+ * @struct ScrollBand
+ * @brief Range of lines (or columns) scrolled together
+ */
+typedef struct ScrollBand
+{
+  /**
+   * @brief First line, or 2 cell column; SCROLL_END ends the list
+   */
+  u16 first;
+  /**
+   * @brief Number of lines or columns
+   */
+  u16 count;
+  /**
+   * @brief Scroll factor (8.8 fixed point)
+   */
+  s16 factor;
+  /**
+   * @brief Change to the factor per line (8.8 fixed point)
+   */
+  s16 slope;
+  /**
+   * @brief Plane (0 for A, 1 for B)
+   */
+  u8 plane;
+  /**
+   * @brief Wobble amplitude in pixels (0 for none)
+   */
+  u8 amp;
+  /**
+   * @brief Wobble phase step per line (256 is a full wave)
+   */
+  u8 freq;
+  /**
+   * @brief Wobble phase step per frame
+   */
+  u8 speed;
+} ScrollBand;
+
+/**
+ * @fn scroll_init_c
+ * @brief Clear the scroll tables and set the number of lines for the mode
+ * @param mode2 Value of VDP Mode Register 2
+ * @param hscroll VRAM address of the HScroll table
+ */
+static inline void scroll_init_c(u8 mode2, u16 hscroll)
+{
+  register u8 d0_mode2 asm("d0") = mode2;
+  register u16 d1_hscroll asm("d1") = hscroll;
+
+  asm volatile(
+    "\
+  jsr scroll_init \n\
+		"
+    : "+d"(d0_mode2), "+d"(d1_hscroll)
+    :
+    : "a0", "cc", "memory");
+}
+
+/**
+ * @fn scroll_hbuild_c
+ * @brief Build HScroll table entries from a list of bands
+ * @param bands Bands, ending with one whose first line is SCROLL_END
+ * @param position Scroll position (e.g. -camera_x)
+ * @param time Time (e.g. a frame counter), for the wobble phase
+ * @note Lines which are not in any band are left as they were in the copy
+ * of the table being built, which alternates each flush
+ */
+static inline void scroll_hbuild_c(
+  ScrollBand const * bands, s16 position, u16 time)
+{
+  register u32 a0_bands asm("a0") = (u32) bands;
+  register s16 d0_position asm("d0") = position;
+  register u16 d1_time asm("d1") = time;
+
+  asm volatile(
+    "\
+  jsr scroll_hbuild \n\
+		"
+    : "+a"(a0_bands), "+d"(d0_position), "+d"(d1_time)
+    :
+    : "a1", "cc", "memory");
+}
+
+/**
+ * @fn scroll_vbuild_c
+ * @brief Build VScroll entries from a list of bands
+ * @param bands Bands over 2 cell columns, ending with one whose first column
+ * is SCROLL_END
+ * @param position Scroll position (e.g. camera_y)
+ * @param time Time (e.g. a frame counter), for the wobble phase
+ */
+static inline void scroll_vbuild_c(
+  ScrollBand const * bands, s16 position, u16 time)
+{
+  register u32 a0_bands asm("a0") = (u32) bands;
+  register s16 d0_position asm("d0") = position;
+  register u16 d1_time asm("d1") = time;
+
+  asm volatile(
+    "\
+  jsr scroll_vbuild \n\
+		"
+    : "+a"(a0_bands), "+d"(d0_position), "+d"(d1_time)
+    :
+    : "a1", "cc", "memory");
+}
+
+/**
+ * @fn scroll_flush_c
+ * @brief Queue the tables built since the last flush for DMA
+ */
+static inline void scroll_flush_c()
+{
+  asm volatile(
+    "\
+  jsr scroll_flush \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+#endif
@@ -0,0 +1,274 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/scroll_main.s
+ * @brief Scroll table builder
+ *
+ * @details
+ * See scroll.def.h for the band format and main/scroll.h for usage. The
+ * tables are sent through the DMA queue, so dmaq_main.s and vdp.s must be
+ * included in the module as well.
+ */
+
+#ifndef MEGADEV__MAIN_SCROLL_S
+#define MEGADEV__MAIN_SCROLL_S
+
+#include <macros.s>
+#include <main/dmaq.def.h>
+#include <main/scroll.def.h>
+#include <main/vdp.def.h>
+#include <main/vdp.macros.s>
+
+.section .text
+
+/**
+ * @fn scroll_init
+ * @brief Clear the scroll tables and set the number of lines for the mode
+ * @param[in] D0.b Value of VDP Mode Register 2
+ * @param[in] D1.w VRAM address of the HScroll table
+ * @clobber d0-d1/a0
+ */
+SUB scroll_init
+  move.w   d1, scroll_hvram
+  move.w   #224, scroll_lines
+  andi.b   #VDP_PAL_VIDEO, d0
+  beq      1f
+  move.w   #240, scroll_lines
+
+1:lea      scroll_tables, a0
+  move.l   a0, scroll_hfront
+  lea      (SCROLL_LINES * 4, a0), a0
+  move.l   a0, scroll_hback
+  lea      (SCROLL_LINES * 4, a0), a0
+  move.l   a0, scroll_vfront
+  lea      (SCROLL_COLUMNS * 4, a0), a0
+  move.l   a0, scroll_vback
+
+  lea      scroll_tables, a0
+  move.w   #(SCROLL_LINES + SCROLL_COLUMNS) * 2 - 1, d0
+2:clr.l    (a0)+
+  dbf      d0, 2b
+  clr.b    scroll_hdirty
+  clr.b    scroll_vdirty
+  rts
+
+/**
+ * @fn scroll_hbuild
+ * @brief Build HScroll table entries from a list of bands
+ * @param[in] A0.l Band list
+ * @param[in] D0.w Scroll position
+ * @param[in] D1.w Time (e.g. a frame counter), for the wobble phase
+ * @clobber d0-d1/a0-a1
+ * @details Each line of a band is set to position * factor / 256, plus the
+ * wobble. Lines not in any band are left as they were in the table being
+ * built, which is not the one built last frame. Bands past the end of the
+ * screen are cut short.
+ */
+SUB scroll_hbuild
+  PUSHM    d2-d7/a2-a4
+  movea.l  scroll_hback, a1
+  movea.w  scroll_lines, a4
+  st       scroll_hdirty
+  bra      scroll_build
+
+/**
+ * @fn scroll_vbuild
+ * @brief Build VScroll entries from a list of bands
+ * @param[in] A0.l Band list
+ * @param[in] D0.w Scroll position
+ * @param[in] D1.w Time (e.g. a frame counter), for the wobble phase
+ * @clobber d0-d1/a0-a1
+ * @details As scroll_hbuild, with 2 cell columns in place of lines.
+ */
+SUB scroll_vbuild
+  PUSHM    d2-d7/a2-a4
+  movea.l  scroll_vback, a1
+  movea.w  #SCROLL_COLUMNS, a4
+  st       scroll_vdirty
+
+/**
+ * @brief Fill a table from a list of bands
+ * @param[in] A0.l Band list
+ * @param[in] A1.l Table
+ * @param[in] A4.w Number of entries for each plane
+ * @param[in] D0.w Scroll position
+ * @param[in] D1.w Time
+ * @details Entries are a word for plane A and a word for plane B, for both
+ * tables. Pops the registers pushed by the callers.
+ */
+scroll_build:
+  lea      scroll_sine, a2
+1:move.w   (a0), d4                // first
+  bmi      9f
+  move.w   a4, d3
+  sub.w    d4, d3                  // room left in the table
+  bls      8f
+  move.w   SCROLL_COUNT(a0), d6
+  cmp.w    d3, d6
+  bls      2f
+  move.w   d3, d6
+2:subq.w   #1, d6
+  bcs      8f
+
+  move.w   d4, d3
+  lsl.w    #2, d3
+  tst.b    SCROLL_PLANE(a0)
+  beq      3f
+  addq.w   #2, d3
+3:lea      (a1,d3.w), a3
+
+  // position * (factor + slope * n) / 256, in 16.16
+  move.w   d0, d5
+  muls.w   SCROLL_FACTOR(a0), d5
+  lsl.l    #8, d5
+  move.w   d0, d7
+  muls.w   SCROLL_SLOPE(a0), d7
+  lsl.l    #8, d7
+
+  tst.b    SCROLL_AMP(a0)
+  bne      6f
+  tst.l    d7
+  bne      5f
+
+  // flat band
+  swap     d5
+4:move.w   d5, (a3)
+  addq.l   #4, a3
+  dbf      d6, 4b
+  bra      8f
+
+  // sloped band
+5:move.l   d5, d3
+  swap     d3
+  move.w   d3, (a3)
+  addq.l   #4, a3
+  add.l    d7, d5
+  dbf      d6, 5b
+  bra      8f
+
+  // wobble, with a phase of time * speed + n * freq
+6:PUSHM    d0-d1
+  moveq    #0, d3
+  move.b   SCROLL_SPEED(a0), d3
+  mulu.w   d1, d3
+  moveq    #0, d1
+  move.b   SCROLL_FREQ(a0), d1
+  mulu.w   d1, d4
+  add.w    d3, d4
+  andi.w   #0xFF, d4
+  moveq    #0, d0
+  move.b   SCROLL_AMP(a0), d0
+7:move.b   (a2,d4.w), d3
+  ext.w    d3
+  muls.w   d0, d3
+  asr.w    #7, d3
+  move.l   d5, d2
+  swap     d2
+  add.w    d2, d3
+  move.w   d3, (a3)
+  addq.l   #4, a3
+  add.l    d7, d5
+  add.b    d1, d4
+  dbf      d6, 7b
+  POPM     d0-d1
+
+8:lea      SCROLL_BAND_SIZE(a0), a0
+  bra      1b
+9:POPM     d2-d7/a2-a4
+  rts
+
+/**
+ * @fn scroll_flush
+ * @brief Queue the tables built since the last flush for DMA
+ * @clobber d0-d1/a0-a1
+ * @details Each table is sent whole. A table which did not fit in the DMA
+ * queue is tried again on the next flush; otherwise, the next build goes to
+ * the other copy of the table, so the one waiting in the queue is never
+ * changed.
+ */
+SUB scroll_flush
+  PUSHM    d2-d3
+  tst.b    scroll_hdirty
+  beq      1f
+  move.w   scroll_hvram, d0
+  TO_VDPPTR d0
+  ori.l    #VRAM_W, d0
+  move.l   scroll_hback, d1
+  move.w   scroll_lines, d2
+  add.w    d2, d2
+  move.w   #(DMAQ_FLAG_WHOLE << 8) | SCROLL_DMA_PRIORITY, d3
+  jsr      dmaq_push
+  bcs      1f
+  move.l   scroll_hfront, d0
+  move.l   scroll_hback, scroll_hfront
+  move.l   d0, scroll_hback
+  clr.b    scroll_hdirty
+
+1:tst.b    scroll_vdirty
+  beq      2f
+  move.l   #VSRAM_W, d0
+  move.l   scroll_vback, d1
+  moveq    #SCROLL_COLUMNS * 2, d2
+  move.w   #(DMAQ_FLAG_WHOLE << 8) | SCROLL_DMA_PRIORITY, d3
+  jsr      dmaq_push
+  bcs      2f
+  move.l   scroll_vfront, d0
+  move.l   scroll_vback, scroll_vfront
+  move.l   d0, scroll_vback
+  clr.b    scroll_vdirty
+2:POPM     d2-d3
+  rts
+
+.section .rodata
+
+// 127 * sin(2 * pi * n / 256)
+scroll_sine:
+  .byte 0, 3, 6, 9, 12, 16, 19, 22, 25, 28, 31, 34, 37, 40, 43, 46
+  .byte 49, 51, 54, 57, 60, 63, 65, 68, 71, 73, 76, 78, 81, 83, 85, 88
+  .byte 90, 92, 94, 96, 98, 100, 102, 104, 106, 107, 109, 111, 112, 113, 115, 116
+  .byte 117, 118, 120, 121, 122, 122, 123, 124, 125, 125, 126, 126, 126, 127, 127, 127
+  .byte 127, 127, 127, 127, 126, 126, 126, 125, 125, 124, 123, 122, 122, 121, 120, 118
+  .byte 117, 116, 115, 113, 112, 111, 109, 107, 106, 104, 102, 100, 98, 96, 94, 92
+  .byte 90, 88, 85, 83, 81, 78, 76, 73, 71, 68, 65, 63, 60, 57, 54, 51
+  .byte 49, 46, 43, 40, 37, 34, 31, 28, 25, 22, 19, 16, 12, 9, 6, 3
+  .byte 0, -3, -6, -9, -12, -16, -19, -22, -25, -28, -31, -34, -37, -40, -43, -46
+  .byte -49, -51, -54, -57, -60, -63, -65, -68, -71, -73, -76, -78, -81, -83, -85, -88
+  .byte -90, -92, -94, -96, -98, -100, -102, -104, -106, -107, -109, -111, -112, -113, -115, -116
+  .byte -117, -118, -120, -121, -122, -122, -123, -124, -125, -125, -126, -126, -126, -127, -127, -127
+  .byte -127, -127, -127, -127, -126, -126, -126, -125, -125, -124, -123, -122, -122, -121, -120, -118
+  .byte -117, -116, -115, -113, -112, -111, -109, -107, -106, -104, -102, -100, -98, -96, -94, -92
+  .byte -90, -88, -85, -83, -81, -78, -76, -73, -71, -68, -65, -63, -60, -57, -54, -51
+  .byte -49, -46, -43, -40, -37, -34, -31, -28, -25, -22, -19, -16, -12, -9, -6, -3
+
+.section .bss
+
+.global scroll_hfront
+scroll_hfront: .long 0
+
+.global scroll_hback
+scroll_hback: .long 0
+
+.global scroll_vfront
+scroll_vfront: .long 0
+
+.global scroll_vback
+scroll_vback: .long 0
+
+.global scroll_hvram
+scroll_hvram: .word 0
+
+.global scroll_lines
+scroll_lines: .word 0
+
+.global scroll_tables
+scroll_tables: .space (SCROLL_LINES + SCROLL_COLUMNS) * 4 * 2
+
+.global scroll_hdirty
+scroll_hdirty: .byte 0
+
+.global scroll_vdirty
+scroll_vdirty: .byte 0
+
+.align 2
+
+#endif
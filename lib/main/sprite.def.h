@@ -0,0 +1,61 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/sprite.def.h
+ * @brief Sprite engine definitions
+ *
+ * @details
+ * A metasprite layout (as made by tools/sprdef.sh) is a word with the number
+ * of pieces, followed by each piece in this format:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | word | Y offset from the origin
+ * 0x02   | word | Y offset when flipped vertically
+ * 0x04   | word | X offset from the origin
+ * 0x06   | word | X offset when flipped horizontally
+ * 0x08   | word | Size (bits 15-12, as in the sprite table) and tile offset
+ *                 from the first tile of the metasprite (bits 10-0)
+ *
+ * Offsets are in pixels and signed.
+ */
+
+#ifndef MEGADEV__MAIN_SPRITE_DEF_H
+#define MEGADEV__MAIN_SPRITE_DEF_H
+
+#define SPR_PIECE_Y     0x00
+#define SPR_PIECE_YFLIP 0x02
+#define SPR_PIECE_X     0x04
+#define SPR_PIECE_XFLIP 0x06
+#define SPR_PIECE_ATTR  0x08
+#define SPR_PIECE_SIZE  10
+
+/**
+ * @def SPR_TABLE_SIZE
+ * @brief Largest sprite table (H40 mode) in entries
+ */
+#define SPR_TABLE_SIZE 80
+
+/**
+ * @def SPR_BANDS
+ * @brief Number of 8 line bands on the tallest (V30) screen
+ */
+#define SPR_BANDS 30
+
+#define SPR_LIMIT_H40        80
+#define SPR_LINE_SPRITES_H40 20
+#define SPR_LINE_CELLS_H40   40
+
+#define SPR_LIMIT_H32        64
+#define SPR_LINE_SPRITES_H32 16
+#define SPR_LINE_CELLS_H32   32
+
+/**
+ * @def SPR_DMA_PRIORITY
+ * @brief Priority of the sprite table in the DMA queue
+ */
+#ifndef SPR_DMA_PRIORITY
+#define SPR_DMA_PRIORITY 0
+#endif
+
+#endif
@@ -0,0 +1,170 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/sprite.h
+ * @brief Sprite engine
+ *
+ * @details
+ * Builds the sprite table from metasprites each frame and sends only the used
+ * part of it through the DMA queue (see main/dmaq.h). Metasprite layouts are
+ * made from .sprdef files with tools/sprdef.sh; see sprite.def.h for the
+ * format.
+ *
+ *   spr_init_c(vdpreg_get(VDP_REG_MODE2), vdpreg_get(VDP_REG_MODE4), 0xF800);
+ *
+ *   // each frame
+ *   spr_begin_c();
+ *   spr_add_c(&player_layout, player_x, player_y, SPR_PAL(1) | PLAYER_TILE);
+ *   ...
+ *   spr_end_c();
+ *
+ * Positions are on screen, in pixels, for the origin of the layout. Pieces
+ * off screen are skipped, and the link chain is built as the table is
+ * written, so the VDP never sees unused entries. Pieces which would be past
+ * the limits of the VDP on any line are dropped, in the order they were
+ * added, so add the most important metasprites first.
+ *
+ * Compared to bios_process_entities, there is no fixed Entity structure to
+ * fill in, no work for entities which are off screen and no copy of the full
+ * table each frame. spr_count, spr_culled and spr_dropped report what
+ * happened in the last frame.
+ *
+ * Be sure to include sprite_main.s, dmaq_main.s and vdp.s in your module when
+ * using these.
+ */
+
+#ifndef MEGADEV__MAIN_SPRITE_H
+#define MEGADEV__MAIN_SPRITE_H
+
+#include "main/sprite.def.h"
+#include "types.h"
+
+/**
+ * @struct SprPiece
+ * @brief One hardware sprite in a metasprite layout
+ */
+typedef struct SprPiece
+{
+  s16 y;
+  s16 y_flip;
+  s16 x;
+  s16 x_flip;
+  /**
+   * @brief Size (bits 15-12) and tile offset (bits 10-0)
+   */
+  u16 attr;
+} SprPiece;
+
+/**
+ * @struct SprLayout
+ * @brief Metasprite layout
+ */
+typedef struct SprLayout
+{
+  u16      count;
+  SprPiece pieces[];
+} SprLayout;
+
+#define SPR_PRIORITY (1 << 15)
+#define SPR_PAL(n)   ((n) << 13)
+#define SPR_VFLIP    (1 << 12)
+#define SPR_HFLIP    (1 << 11)
+
+/**
+ * @var spr_count
+ * @brief Number of hardware sprites in the last table
+ */
+extern u16 volatile spr_count;
+
+/**
+ * @var spr_culled
+ * @brief Number of pieces skipped as off screen in the current frame
+ */
+extern u16 volatile spr_culled;
+
+/**
+ * @var spr_dropped
+ * @brief Number of pieces dropped for going over the VDP limits in the
+ * current frame
+ */
+extern u16 volatile spr_dropped;
+
+/**
+ * @fn spr_init_c
+ * @brief Set up the sprite engine for the video mode
+ * @param mode2 Value of VDP Mode Register 2
+ * @param mode4 Value of VDP Mode Register 4
+ * @param table VRAM address of the sprite table
+ * @details Also begins the first frame.
+ */
+static inline void spr_init_c(u8 mode2, u8 mode4, u16 table)
+{
+  register u8  d0_mode2 asm("d0") = mode2;
+  register u8  d1_mode4 asm("d1") = mode4;
+  register u16 d2_table asm("d2") = table;
+
+  asm volatile(
+    "\
+  jsr spr_init \n\
+		"
+    : "+d"(d0_mode2), "+d"(d1_mode4)
+    : "d"(d2_table)
+    : "a0", "cc", "memory");
+}
+
+/**
+ * @fn spr_begin_c
+ * @brief Start building the sprite table for a new frame
+ */
+static inline void spr_begin_c()
+{
+  asm volatile(
+    "\
+  jsr spr_begin \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "cc", "memory");
+}
+
+/**
+ * @fn spr_add_c
+ * @brief Add a metasprite to the sprite table
+ * @param layout Metasprite layout
+ * @param x X position on screen
+ * @param y Y position on screen
+ * @param attr Sprite attributes: SPR_PRIORITY, SPR_PAL(n), SPR_VFLIP and
+ * SPR_HFLIP, plus the index of the first tile
+ */
+static inline void spr_add_c(SprLayout const * layout, s16 x, s16 y, u16 attr)
+{
+  register u32 a0_layout asm("a0") = (u32) layout;
+  register s16 d0_x asm("d0") = x;
+  register s16 d1_y asm("d1") = y;
+  register u16 d2_attr asm("d2") = attr;
+
+  asm volatile(
+    "\
+  jsr spr_add \n\
+		"
+    : "+a"(a0_layout), "+d"(d0_x), "+d"(d1_y)
+    : "d"(d2_attr)
+    : "a1", "cc", "memory");
+}
+
+/**
+ * @fn spr_end_c
+ * @brief Finish the sprite table and queue it for DMA
+ */
+static inline void spr_end_c()
+{
+  asm volatile(
+    "\
+  jsr spr_end \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+#endif
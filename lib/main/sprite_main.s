@@ -0,0 +1,289 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/sprite_main.s
+ * @brief Sprite engine
+ *
+ * @details
+ * See sprite.def.h for the metasprite layout format and main/sprite.h for
+ * usage. The sprite table is sent through the DMA queue, so dmaq_main.s and
+ * vdp.s must be included in the module as well.
+ */
+
+#ifndef MEGADEV__MAIN_SPRITE_S
+#define MEGADEV__MAIN_SPRITE_S
+
+#include <macros.s>
+#include <main/dmaq.def.h>
+#include <main/sprite.def.h>
+#include <main/vdp.def.h>
+#include <main/vdp.macros.s>
+
+.section .text
+
+/**
+ * @fn spr_init
+ * @brief Set up the sprite engine for the video mode
+ * @param[in] D0.b Value of VDP Mode Register 2
+ * @param[in] D1.b Value of VDP Mode Register 4
+ * @param[in] D2.w VRAM address of the sprite table
+ * @clobber d0-d1/a0
+ */
+SUB spr_init
+  andi.b   #VDP_PAL_VIDEO, d0
+  beq      1f
+  move.w   #240, spr_height
+  bra      2f
+1:move.w   #224, spr_height
+
+2:andi.b   #VDP_MASK_WIDTH_40CELL, d1
+  beq      3f
+  move.w   #320, spr_width
+  move.w   #SPR_LIMIT_H40, spr_limit
+  move.w   #(SPR_LINE_SPRITES_H40 << 8) | SPR_LINE_CELLS_H40, spr_line_limits
+  bra      4f
+3:move.w   #256, spr_width
+  move.w   #SPR_LIMIT_H32, spr_limit
+  move.w   #(SPR_LINE_SPRITES_H32 << 8) | SPR_LINE_CELLS_H32, spr_line_limits
+
+4:move.w   d2, d0
+  TO_VDPPTR d0
+  ori.l    #VRAM_W, d0
+  move.l   d0, spr_vram
+  move.l   #spr_tables, spr_table
+  bra      spr_begin
+
+/**
+ * @fn spr_begin
+ * @brief Start building the sprite table for a new frame
+ * @clobber d0-d1/a0
+ */
+SUB spr_begin
+  move.l   spr_table, spr_ptr
+  move.w   #1, spr_link
+  clr.w    spr_culled
+  clr.w    spr_dropped
+  lea      spr_bands, a0
+  move.w   spr_line_limits, d0
+  moveq    #SPR_BANDS - 1, d1
+0:move.w   d0, (a0)+
+  dbf      d1, 0b
+  rts
+
+/**
+ * @fn spr_add
+ * @brief Add a metasprite to the sprite table
+ * @param[in] A0.l Pointer to the layout
+ * @param[in] D0.w X position on screen
+ * @param[in] D1.w Y position on screen
+ * @param[in] D2.w Sprite attributes (priority, palette, flip bits and first
+ * tile, as in the sprite table)
+ * @clobber d0-d1/a0-a1
+ * @details Pieces which are entirely off screen are skipped (and counted in
+ * spr_culled). Pieces which would go over the number of sprites or sprite
+ * pixels the VDP can show on a line, or over the size of the table, are
+ * dropped (and counted in spr_dropped). Lines are tracked in bands of 8, so
+ * a piece may be dropped from a band which is full on other lines than its
+ * own. Metasprites added first are never dropped for those added after.
+ */
+SUB spr_add
+  PUSHM    d2-d7/a2-a4
+  movea.w  d0, a2                  // x
+  movea.w  d1, a3                  // y
+  lea      spr_bands, a4
+  movea.l  spr_ptr, a1
+  move.w   (a0)+, d7
+  beq      9f
+  subq.w   #1, d7
+  swap     d7
+  move.w   spr_link, d7            // upper word: link for the next entry
+  swap     d7
+
+  // offsets to use in each piece, depending on the flip bits
+  moveq    #SPR_PIECE_X, d3
+  btst     #11, d2
+  beq      1f
+  moveq    #SPR_PIECE_XFLIP, d3
+1:swap     d3
+  move.w   #SPR_PIECE_Y, d3
+  btst     #12, d2
+  beq      2f
+  move.w   #SPR_PIECE_YFLIP, d3
+
+2:move.l   d7, d0
+  swap     d0
+  cmp.w    spr_limit, d0
+  bhi      7f
+
+  move.w   (a0,d3.w), d5
+  add.w    a3, d5                  // y on screen
+  swap     d3
+  move.w   (a0,d3.w), d6
+  add.w    a2, d6                  // x on screen
+  swap     d3
+  moveq    #0, d4
+  move.b   SPR_PIECE_ATTR(a0), d4
+  lsr.b    #4, d4                  // size
+
+  // cull
+  cmp.w    spr_height, d5
+  bge      6f
+  cmp.w    spr_width, d6
+  bge      6f
+  moveq    #3, d0
+  and.w    d4, d0
+  addq.w   #1, d0
+  lsl.w    #3, d0
+  add.w    d5, d0                  // bottom
+  ble      6f
+  move.w   d4, d1
+  lsr.w    #2, d1
+  addq.w   #1, d1
+  lsl.w    #3, d1
+  add.w    d6, d1                  // right
+  ble      6f
+
+  // bands covered
+  cmp.w    spr_height, d0
+  ble      3f
+  move.w   spr_height, d0
+3:subq.w   #1, d0
+  lsr.w    #3, d0
+  move.w   d5, d1
+  bpl      4f
+  moveq    #0, d1
+4:lsr.w    #3, d1
+  sub.w    d1, d0                  // bands - 1
+  add.w    d1, d1                  // offset of the first band
+
+  // write the entry, which is only kept if it fits
+  addi.w   #128, d6
+  move.w   d6, 6(a1)
+  addi.w   #128, d5
+  move.w   d5, (a1)
+  move.b   d4, 2(a1)
+  move.l   d7, d5
+  swap     d5
+  move.b   d5, 3(a1)
+  move.w   SPR_PIECE_ATTR(a0), d5
+  andi.w   #0x7FF, d5
+  add.w    d2, d5
+  move.w   d5, 4(a1)
+
+  // the piece must fit on every band it covers
+  move.w   d4, d6
+  lsr.w    #2, d6
+  addq.w   #1, d6                  // width in cells
+  move.w   d0, d4
+  move.w   d1, d5
+10:tst.b   (a4,d1.w)
+  beq      7f
+  cmp.b    1(a4,d1.w), d6
+  bhi      7f
+  addq.w   #2, d1
+  dbf      d0, 10b
+11:subq.b  #1, (a4,d5.w)
+  sub.b    d6, 1(a4,d5.w)
+  addq.w   #2, d5
+  dbf      d4, 11b
+
+  addq.l   #8, a1
+  swap     d7
+  addq.w   #1, d7
+  swap     d7
+  bra      8f
+
+6:addq.w   #1, spr_culled
+  bra      8f
+7:addq.w   #1, spr_dropped
+8:lea      SPR_PIECE_SIZE(a0), a0
+  dbf      d7, 2b
+
+  move.l   a1, spr_ptr
+  swap     d7
+  move.w   d7, spr_link
+9:POPM     d2-d7/a2-a4
+  rts
+
+/**
+ * @fn spr_end
+ * @brief Finish the sprite table and queue it for DMA
+ * @clobber d0-d1/a0-a1
+ * @details Only the entries which were used are sent. The engine switches to
+ * its other table for the next frame, so the one which was queued is left
+ * alone until it has been sent.
+ */
+SUB spr_end
+  PUSHM    d2-d3
+  movea.l  spr_ptr, a1
+  move.w   spr_link, d2
+  subq.w   #1, d2
+  bne      1f
+
+  // nothing to show: a single sprite above the screen
+  movea.l  spr_table, a1
+  clr.l    (a1)+
+  move.l   #1, (a1)
+  moveq    #1, d2
+  bra      2f
+1:clr.b    (3 - 8, a1)             // end of the link chain
+
+2:move.w   d2, spr_count
+  lsl.w    #2, d2
+  move.l   spr_vram, d0
+  move.l   spr_table, d1
+  move.w   #(DMAQ_FLAG_WHOLE << 8) | SPR_DMA_PRIORITY, d3
+  jsr      dmaq_push
+
+  cmpi.l   #spr_tables, spr_table
+  bne      3f
+  move.l   #spr_tables + SPR_TABLE_SIZE * 8, spr_table
+  bra      4f
+3:move.l   #spr_tables, spr_table
+4:POPM     d2-d3
+  rts
+
+.section .bss
+
+.global spr_tables
+spr_tables: .space SPR_TABLE_SIZE * 8 * 2
+
+.global spr_table
+spr_table: .long 0
+
+.global spr_ptr
+spr_ptr: .long 0
+
+.global spr_vram
+spr_vram: .long 0
+
+.global spr_link
+spr_link: .word 0
+
+.global spr_limit
+spr_limit: .word 0
+
+.global spr_line_limits
+spr_line_limits: .word 0
+
+.global spr_width
+spr_width: .word 0
+
+.global spr_height
+spr_height: .word 0
+
+.global spr_count
+spr_count: .word 0
+
+.global spr_culled
+spr_culled: .word 0
+
+.global spr_dropped
+spr_dropped: .word 0
+
+.global spr_bands
+spr_bands: .space SPR_BANDS * 2
+
+.align 2
+
+#endif
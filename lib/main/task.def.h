@@ -0,0 +1,53 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/task.def.h
+ * @brief Cooperative task scheduler definitions
+ *
+ * @details
+ * Each task is a fixed size frame in a pool supplied by the program:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | long | Next task in the run list
+ * 0x04   | long | Previous task in the run list
+ * 0x08   | long | Handler, or 0 if the frame is free
+ * 0x0C   | word | Frames left to sleep
+ * 0x0E   | byte | Priority
+ * 0x0F   | byte | (Reserved)
+ * 0x10   | word | Time used in the last run (TASK_PROFILE only)
+ * 0x12   | word | Most time used in a single run (TASK_PROFILE only)
+ * 0x14   | ...  | Task data, free for use by the handler
+ */
+
+#ifndef MEGADEV__MAIN_TASK_DEF_H
+#define MEGADEV__MAIN_TASK_DEF_H
+
+#define TASK_NEXT     0x00
+#define TASK_PREV     0x04
+#define TASK_HANDLER  0x08
+#define TASK_SLEEP    0x0C
+#define TASK_PRIORITY 0x0E
+#define TASK_FLAGS    0x0F
+#define TASK_CPU_LAST 0x10
+#define TASK_CPU_MAX  0x12
+#define TASK_DATA     0x14
+
+/**
+ * @def TASK_SIZE
+ * @brief Size of a task frame in bytes
+ */
+#define TASK_SIZE 64
+
+#define TASK_DATA_SIZE (TASK_SIZE - TASK_DATA)
+
+/**
+ * @def TASK_PRIORITIES
+ * @brief Number of priority levels
+ * @details Priority 0 runs first each frame.
+ */
+#ifndef TASK_PRIORITIES
+#define TASK_PRIORITIES 4
+#endif
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/task.h
+ * @brief Cooperative task scheduler
+ *
+ * @details
+ * Tasks are handlers which are called once per frame, each with its own
+ * fixed size frame for state. They are kept in a run list per priority, so
+ * starting and ending a task takes the same time regardless of how many are
+ * running. A task can also sleep for a number of frames.
+ *
+ * The frames come from a pool which the program provides, for example in the
+ * kernel:
+ *
+ *   Task task_pool[32];
+ *
+ *   task_init_c(task_pool, 32);
+ *   task_spawn_c(player_task, 1);
+ *
+ *   while (1)
+ *   {
+ *     bios_vblank_wait_default();
+ *     task_run_c();
+ *   }
+ *
+ * As the tasks are cooperative, each handler must return within the frame. A
+ * handler which needs to wait can keep a state in its task data and sleep.
+ *
+ * When built with TASK_PROFILE, the number of scanlines each handler uses is
+ * kept in its frame, and can be passed to a hook (see
+ * @ref task_profile_hook).
+ *
+ * Be sure to include task_main.s in your module when using these.
+ */
+
+#ifndef MEGADEV__MAIN_TASK_H
+#define MEGADEV__MAIN_TASK_H
+
+#include "main/task.def.h"
+#include "types.h"
+
+typedef struct Task Task;
+
+/**
+ * @typedef TaskHandler
+ * @brief Task handler, called once per frame while the task is awake
+ * @param task Pointer to the task
+ */
+typedef void (*TaskHandler)(Task * task);
+
+/**
+ * @struct Task
+ * @brief Task frame (see task.def.h)
+ */
+struct Task
+{
+  Task *      next;
+  Task *      prev;
+  TaskHandler handler;
+  /**
+   * @brief Frames left to sleep
+   */
+  u16 sleep;
+  u8  priority;
+  u8  flags;
+  /**
+   * @brief Scanlines used in the last run (TASK_PROFILE only)
+   */
+  u16 cpu_last;
+  /**
+   * @brief Most scanlines used in a single run (TASK_PROFILE only)
+   */
+  u16 cpu_max;
+  /**
+   * @brief Free for use by the handler
+   */
+  u8 data[TASK_DATA_SIZE];
+};
+
+/**
+ * @var task_current
+ * @brief The task whose handler is running, or NULL outside of task_run
+ */
+extern Task * volatile task_current;
+
+#ifdef TASK_PROFILE
+/**
+ * @var task_profile_hook
+ * @brief Called after each handler with the task and the scanlines it used
+ * @details Set to NULL (the default) for no hook. The count is taken from the
+ * V counter, so it is only correct for handlers which take less than a
+ * frame.
+ */
+extern void (*volatile task_profile_hook)(Task * task, u16 lines);
+#endif
+
+/**
+ * @fn task_init_c
+ * @brief Set up the scheduler with a pool of task frames
+ * @param pool Pointer to the pool
+ * @param count Number of frames in the pool
+ */
+static inline void task_init_c(Task * pool, u16 count)
+{
+  register u32 a0_pool asm("a0") = (u32) pool;
+  register u16 d0_count asm("d0") = count;
+
+  asm volatile(
+    "\
+  jsr task_init \n\
+		"
+    : "+a"(a0_pool), "+d"(d0_count)
+    :
+    : "d1", "a1", "cc", "memory");
+}
+
+/**
+ * @fn task_spawn_c
+ * @brief Start a new task
+ * @param handler Handler function
+ * @param priority Priority (0 runs first, up to TASK_PRIORITIES - 1)
+ * @return Pointer to the task, or NULL if there are no free task frames
+ * @details The task data is cleared.
+ */
+static inline Task * task_spawn_c(TaskHandler handler, u8 priority)
+{
+  register u32 a0_task asm("a0");
+  register u32 a1_handler asm("a1") = (u32) handler;
+  register u16 d0_priority asm("d0") = priority;
+
+  asm volatile(
+    "\
+  jsr task_spawn \n\
+  bcc 1f \n\
+  suba.l a0, a0 \n\
+1: \n\
+		"
+    : "=a"(a0_task), "+a"(a1_handler), "+d"(d0_priority)
+    :
+    : "d1", "cc", "memory");
+
+  return (Task *) a0_task;
+}
+
+/**
+ * @fn task_kill_c
+ * @brief End a task and return its frame to the pool
+ * @details A handler may kill its own task, but must not use its task frame
+ * afterward.
+ */
+static inline void task_kill_c(Task * task)
+{
+  register u32 a0_task asm("a0") = (u32) task;
+
+  asm volatile(
+    "\
+  jsr task_kill \n\
+		"
+    : "+a"(a0_task)
+    :
+    : "d0", "d1", "a1", "cc", "memory");
+}
+
+/**
+ * @fn task_run_c
+ * @brief Run every awake task once, in order of priority
+ * @note Call once per frame from the main loop, not from an interrupt
+ */
+static inline void task_run_c()
+{
+  asm volatile(
+    "\
+  jsr task_run \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+/**
+ * @fn task_sleep
+ * @brief Skip a task for a number of frames
+ * @details Usually called by a handler on its own task before returning.
+ */
+static inline void task_sleep(Task * task, u16 frames)
+{
+  task->sleep = frames;
+}
+
+/**
+ * @fn task_wake
+ * @brief Run a sleeping task again from the next time it is reached
+ */
+static inline void task_wake(Task * task)
+{
+  task->sleep = 0;
+}
+
+#endif
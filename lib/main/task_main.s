@@ -0,0 +1,227 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/task_main.s
+ * @brief Cooperative task scheduler
+ *
+ * @details
+ * See task.def.h for the task frame layout and main/task.h for usage.
+ */
+
+#ifndef MEGADEV__MAIN_TASK_S
+#define MEGADEV__MAIN_TASK_S
+
+#include <macros.s>
+#include <main/task.def.h>
+#ifdef TASK_PROFILE
+#include <main/vdp.def.h>
+#endif
+
+.section .text
+
+/**
+ * @fn task_init
+ * @brief Set up the scheduler with a pool of task frames
+ * @param[in] A0.l Pointer to the pool (which must be word aligned)
+ * @param[in] D0.w Number of frames in the pool
+ * @clobber d0-d1/a0-a1
+ * @note Any tasks from a previous pool are dropped
+ */
+SUB task_init
+  lea      task_heads, a1
+  moveq    #TASK_PRIORITIES * 2 - 1, d1   // heads and tails
+0:clr.l    (a1)+
+  dbf      d1, 0b
+  clr.l    task_next
+  clr.l    task_current
+  clr.l    task_free
+  tst.w    d0
+  beq      3f
+
+  // chain every frame into the free list
+  move.l   a0, task_free
+  subq.w   #1, d0
+  bra      2f
+1:lea      TASK_SIZE(a0), a1
+  move.l   a1, TASK_NEXT(a0)
+  clr.l    TASK_HANDLER(a0)
+  movea.l  a1, a0
+2:dbf      d0, 1b
+  clr.l    TASK_NEXT(a0)
+  clr.l    TASK_HANDLER(a0)
+3:rts
+
+/**
+ * @fn task_spawn
+ * @brief Start a new task
+ * @param[in] A1.l Pointer to the handler
+ * @param[in] D0.b Priority (0 to TASK_PRIORITIES - 1)
+ * @param[out] A0.l Pointer to the task
+ * @param[out] CC Task started
+ * @param[out] CS No free task frames
+ * @clobber d0-d1/a1
+ * @details The frame is cleared and the task is added to the end of the run
+ * list for its priority, so it runs in the current frame if that priority
+ * has not been reached yet.
+ */
+SUB task_spawn
+  movea.l  task_free, a0
+  move.l   a0, d1
+  beq      9f
+  move.l   TASK_NEXT(a0), task_free
+
+  lea      TASK_SIZE(a0), a0
+  moveq    #TASK_SIZE / 4 - 1, d1
+0:clr.l    -(a0)
+  dbf      d1, 0b
+  move.l   a1, TASK_HANDLER(a0)
+  cmpi.b   #TASK_PRIORITIES, d0
+  bcs      1f
+  moveq    #TASK_PRIORITIES - 1, d0
+1:move.b   d0, TASK_PRIORITY(a0)
+
+  // add to the end of the run list
+  andi.w   #0xFF, d0
+  lsl.w    #2, d0
+  lea      task_tails, a1
+  adda.w   d0, a1
+  move.l   (a1), d1
+  move.l   a0, (a1)
+  move.l   d1, TASK_PREV(a0)
+  beq      2f
+  movea.l  d1, a1
+  move.l   a0, TASK_NEXT(a1)
+  bra      3f
+2:lea      task_heads, a1
+  move.l   a0, (a1,d0.w)
+3:move     #0, ccr
+  rts
+
+9:move     #1, ccr
+  rts
+
+/**
+ * @fn task_kill
+ * @brief End a task and return its frame to the pool
+ * @param[in] A0.l Pointer to the task
+ * @clobber d0-d1/a1
+ * @details May be called on any task at any time, including by a handler on
+ * its own task. Killing a task which has already ended does nothing.
+ */
+SUB task_kill
+  tst.l    TASK_HANDLER(a0)
+  beq      9f
+  clr.l    TASK_HANDLER(a0)
+
+  // if this is the next task to run, the run loop moves past it
+  cmpa.l   task_next, a0
+  bne      0f
+  move.l   TASK_NEXT(a0), task_next
+
+0:moveq    #0, d0
+  move.b   TASK_PRIORITY(a0), d0
+  lsl.w    #2, d0
+  move.l   TASK_PREV(a0), d1
+  beq      1f
+  movea.l  d1, a1
+  move.l   TASK_NEXT(a0), TASK_NEXT(a1)
+  bra      2f
+1:lea      task_heads, a1
+  move.l   TASK_NEXT(a0), (a1,d0.w)
+2:move.l   TASK_NEXT(a0), d1
+  beq      3f
+  movea.l  d1, a1
+  move.l   TASK_PREV(a0), TASK_PREV(a1)
+  bra      4f
+3:lea      task_tails, a1
+  move.l   TASK_PREV(a0), (a1,d0.w)
+
+4:move.l   task_free, TASK_NEXT(a0)
+  move.l   a0, task_free
+9:rts
+
+/**
+ * @fn task_run
+ * @brief Run every task once, in order of priority
+ * @clobber d0-d1/a0-a1
+ * @details Meant to be called once per frame from the main loop (not from an
+ * interrupt). Handlers are called as C functions:
+ *   void handler(Task * task)
+ * A sleeping task is skipped and its sleep count decremented instead.
+ */
+SUB task_run
+  PUSHM    d2-d3/a2
+  moveq    #0, d2                  // run list offset
+0:lea      task_heads, a0
+  move.l   (a0,d2.w), d0
+  bra      8f
+
+1:movea.l  d0, a2
+  move.l   TASK_NEXT(a2), task_next
+  tst.w    TASK_SLEEP(a2)
+  beq      2f
+  subq.w   #1, TASK_SLEEP(a2)
+  bra      7f
+
+2:move.l   a2, task_current
+#ifdef TASK_PROFILE
+  move.b   VDP_HVCOUNTER, d3
+#endif
+  movea.l  TASK_HANDLER(a2), a0
+  move.l   a2, -(sp)
+  jsr      (a0)
+  addq.l   #4, sp
+#ifdef TASK_PROFILE
+  // scanlines used by the handler, if the task is still alive
+  moveq    #0, d0
+  move.b   VDP_HVCOUNTER, d0
+  sub.b    d3, d0
+  tst.l    TASK_HANDLER(a2)
+  beq      7f
+  move.w   d0, TASK_CPU_LAST(a2)
+  cmp.w    TASK_CPU_MAX(a2), d0
+  bls      3f
+  move.w   d0, TASK_CPU_MAX(a2)
+3:move.l   task_profile_hook, d1
+  beq      7f
+  movea.l  d1, a0
+  move.l   d0, -(sp)
+  move.l   a2, -(sp)
+  jsr      (a0)
+  addq.l   #8, sp
+#endif
+
+7:move.l   task_next, d0
+8:bne      1b
+  addq.w   #4, d2
+  cmpi.w   #TASK_PRIORITIES * 4, d2
+  bcs      0b
+
+  clr.l    task_current
+  clr.l    task_next
+  POPM     d2-d3/a2
+  rts
+
+.section .bss
+
+.global task_heads
+task_heads: .space TASK_PRIORITIES * 4
+
+.global task_tails
+task_tails: .space TASK_PRIORITIES * 4
+
+.global task_free
+task_free: .long 0
+
+.global task_next
+task_next: .long 0
+
+.global task_current
+task_current: .long 0
+
+#ifdef TASK_PROFILE
+.global task_profile_hook
+task_profile_hook: .long 0
+#endif
+
+#endif
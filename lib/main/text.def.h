@@ -0,0 +1,43 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/text.def.h
+ * @brief Text renderer definitions
+ */
+
+#ifndef MEGADEV__MAIN_TEXT_DEF_H
+#define MEGADEV__MAIN_TEXT_DEF_H
+
+/**
+ * @def TEXT_COLS
+ * @brief Width of the text area in cells
+ * @details Must be no wider than the plane.
+ */
+#ifndef TEXT_COLS
+#define TEXT_COLS 40
+#endif
+
+/**
+ * @def TEXT_ROWS
+ * @brief Height of the text area in cells
+ */
+#ifndef TEXT_ROWS
+#define TEXT_ROWS 28
+#endif
+
+/**
+ * @def TEXT_FIRST_CHAR
+ * @brief Character of the first tile of the font
+ * @details The 1bpp system font starts at the space character.
+ */
+#define TEXT_FIRST_CHAR 0x20
+
+/**
+ * @def TEXT_DMA_PRIORITY
+ * @brief Priority of text updates in the DMA queue
+ */
+#ifndef TEXT_DMA_PRIORITY
+#define TEXT_DMA_PRIORITY 2
+#endif
+
+#endif
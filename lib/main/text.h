@@ -0,0 +1,197 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/text.h
+ * @brief Text renderer
+ *
+ * @details
+ * Keeps a copy of a rectangle of a plane in RAM, and prints into that copy
+ * instead of writing to the VDP. Only the cells which change are marked, and
+ * text_flush_c queues one DMA per changed row (see main/dmaq.h), so a screen
+ * of text can be printed again every frame while costing only what changed.
+ *
+ *   // load the font, e.g. lib/sysfont.1bpp.chr, to tiles 0x20 on with color 1
+ *   text_load_font_c(sysfont, 0x20, 1);
+ *   text_init_c(BIOS_VDP_DEFAULT_PLANEA, 64, 0x20);
+ *
+ *   // each frame
+ *   text_print_c(1, 1, "Free blocks:");
+ *   text_hex16_c(14, 1, free);
+ *   text_dec16_c(14, 2, frame);
+ *   text_flush_c();
+ *
+ * The font is 1bpp with one tile per character from the space to 0x7F, and
+ * is loaded with the Boot ROM (bios_load_1bpp_tiles) while the display is
+ * disabled. text_base can be changed between prints for another palette.
+ *
+ * Be sure to include text_main.s, dmaq_main.s and vdp.s in your module when
+ * using these.
+ */
+
+#ifndef MEGADEV__MAIN_TEXT_H
+#define MEGADEV__MAIN_TEXT_H
+
+#include "main/bios.h"
+#include "main/text.def.h"
+#include "main/vdp.h"
+#include "str_util.h"
+#include "types.h"
+
+/**
+ * @var text_base
+ * @brief Nametable entry of the space character
+ * @details Set by @ref text_init_c. Characters are printed as this entry plus
+ * their offset from the space.
+ */
+extern u16 text_base;
+
+/**
+ * @var text_buffer
+ * @brief Copy of the text area, row by row
+ */
+extern u16 const text_buffer[TEXT_ROWS][TEXT_COLS];
+
+/**
+ * @fn text_load_font_c
+ * @brief Load a 1bpp font into VRAM
+ * @param font 1bpp font, from the space character to 0x7F
+ * @param tile First tile
+ * @param color Palette index of the characters (on a clear background)
+ */
+static inline void text_load_font_c(void const * font, u16 tile, u8 color)
+{
+  u32 pattern = ((u32) color << 16) | (color << 12) | (color << 4) | color;
+
+  bios_load_1bpp_tiles((void *) font,
+                       0x80 - TEXT_FIRST_CHAR,
+                       to_vdp_addr(tile << 5) | VRAM_W,
+                       pattern);
+}
+
+/**
+ * @fn text_init_c
+ * @brief Set up the text area and clear it
+ * @param vram VRAM address of the top left cell of the text area
+ * @param plane_width Width of the plane (in cells)
+ * @param base Nametable entry of the space character (its tile index, along
+ * with the palette and priority bits for the text)
+ */
+static inline void text_init_c(u16 vram, u16 plane_width, u16 base)
+{
+  register u16 d0_vram asm("d0") = vram;
+  register u16 d1_width asm("d1") = plane_width;
+  register u16 d2_base asm("d2") = base;
+
+  asm volatile(
+    "\
+  jsr text_init \n\
+		"
+    : "+d"(d0_vram), "+d"(d1_width)
+    : "d"(d2_base)
+    : "a0", "cc", "memory");
+}
+
+/**
+ * @fn text_print_c
+ * @brief Write a string to the text area
+ * @param x Column
+ * @param y Row
+ * @param string String (0 terminated); a newline goes to column x of the
+ * next row
+ */
+static inline void text_print_c(u16 x, u16 y, char const * string)
+{
+  register u32 a0_string asm("a0") = (u32) string;
+  register u16 d0_x asm("d0") = x;
+  register u16 d1_y asm("d1") = y;
+
+  asm volatile(
+    "\
+  jsr text_print \n\
+		"
+    : "+a"(a0_string), "+d"(d0_x), "+d"(d1_y)
+    :
+    : "cc", "memory");
+}
+
+/**
+ * @fn text_hex8_c
+ * @brief Write an 8 bit value in hexadecimal (2 digits)
+ */
+static inline void text_hex8_c(u16 x, u16 y, u8 value)
+{
+  char buffer[3];
+  hextoa8(value, buffer);
+  buffer[2] = 0;
+  text_print_c(x, y, buffer);
+}
+
+/**
+ * @fn text_hex16_c
+ * @brief Write a 16 bit value in hexadecimal (4 digits)
+ */
+static inline void text_hex16_c(u16 x, u16 y, u16 value)
+{
+  char buffer[5];
+  hextoa16(value, buffer);
+  buffer[4] = 0;
+  text_print_c(x, y, buffer);
+}
+
+/**
+ * @fn text_hex32_c
+ * @brief Write a 32 bit value in hexadecimal (8 digits)
+ */
+static inline void text_hex32_c(u16 x, u16 y, u32 value)
+{
+  char buffer[9];
+  hextoa32(value, buffer);
+  buffer[8] = 0;
+  text_print_c(x, y, buffer);
+}
+
+/**
+ * @fn text_dec16_c
+ * @brief Write a 16 bit value in decimal (5 characters, right aligned)
+ */
+static inline void text_dec16_c(u16 x, u16 y, u16 value)
+{
+  char buffer[6];
+  dectoa16(value, buffer);
+  for (u8 i = 0; i < 4 && buffer[i] == '0'; ++i)
+    buffer[i] = ' ';
+  buffer[5] = 0;
+  text_print_c(x, y, buffer);
+}
+
+/**
+ * @fn text_clear_c
+ * @brief Fill the text area with spaces
+ */
+static inline void text_clear_c()
+{
+  asm volatile(
+    "\
+  jsr text_clear \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+/**
+ * @fn text_flush_c
+ * @brief Queue the changed parts of the text area for DMA
+ */
+static inline void text_flush_c()
+{
+  asm volatile(
+    "\
+  jsr text_flush \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/text_main.s
+ * @brief Text renderer
+ *
+ * @details
+ * See main/text.h for usage. Changed rows are sent through the DMA queue, so
+ * dmaq_main.s and vdp.s must be included in the module as well.
+ */
+
+#ifndef MEGADEV__MAIN_TEXT_S
+#define MEGADEV__MAIN_TEXT_S
+
+#include <macros.s>
+#include <main/dmaq.def.h>
+#include <main/text.def.h>
+#include <main/vdp.def.h>
+#include <main/vdp.macros.s>
+
+.section .text
+
+/**
+ * @fn text_init
+ * @brief Set up the text area and clear it
+ * @param[in] D0.w VRAM address of the top left cell of the text area
+ * @param[in] D1.w Width of the plane (in cells)
+ * @param[in] D2.w Nametable entry of the space character (the first tile of
+ * the font, with the palette and priority bits for the text)
+ * @clobber d0-d1/a0
+ * @details The whole area is sent on the next flush.
+ */
+SUB text_init
+  move.w   d0, text_vram
+  add.w    d1, d1
+  move.w   d1, text_stride
+  move.w   d2, text_base
+
+  lea      text_buffer, a0
+  move.w   #TEXT_COLS * TEXT_ROWS - 1, d0
+1:move.w   d2, (a0)+
+  dbf      d0, 1b
+
+  lea      text_dirty, a0
+  moveq    #TEXT_ROWS - 1, d0
+2:move.w   #TEXT_COLS - 1, (a0)+
+  dbf      d0, 2b
+  rts
+
+/**
+ * @fn text_print
+ * @brief Write a string to the text area
+ * @param[in] A0.l Pointer to the string (0 terminated)
+ * @param[in] D0.w Column
+ * @param[in] D1.w Row
+ * @param[out] D0.w Column after the string
+ * @param[out] D1.w Row after the string
+ * @clobber a0
+ * @details A newline goes to the starting column of the next row. Text past
+ * the edges of the area is cut off. Characters outside of the font (below the
+ * space, or from 0x80 on) leave their cell as it was. Only the cells which
+ * change are marked for the next flush, so printing the same text again costs
+ * no DMA.
+ */
+SUB text_print
+  PUSHM    d2-d5/a2-a3
+  move.w   d0, d5
+1:cmpi.w   #TEXT_ROWS, d1
+  bcc      9f
+  move.w   d1, d2
+  mulu.w   #TEXT_COLS * 2, d2
+  lea      text_buffer, a2
+  adda.l   d2, a2
+  lea      text_dirty, a3
+  move.w   d1, d2
+  add.w    d2, d2
+  adda.w   d2, a3
+
+2:moveq    #0, d2
+  move.b   (a0)+, d2
+  beq      9f
+  cmpi.b   #0x0A, d2               // newline
+  beq      8f
+  cmpi.w   #TEXT_COLS, d0
+  bcc      7f
+  subi.w   #TEXT_FIRST_CHAR, d2
+  bcs      7f
+  cmpi.w   #0x80 - TEXT_FIRST_CHAR, d2
+  bcc      7f                      // past the end of the font
+  add.w    text_base, d2
+  move.w   d0, d3
+  add.w    d3, d3
+  cmp.w    (a2,d3.w), d2
+  beq      7f
+  move.w   d2, (a2,d3.w)
+  cmp.b    (a3), d0
+  bcc      3f
+  move.b   d0, (a3)
+3:cmp.b    1(a3), d0
+  bls      7f
+  move.b   d0, 1(a3)
+7:addq.w   #1, d0
+  bra      2b
+
+8:move.w   d5, d0
+  addq.w   #1, d1
+  bra      1b
+
+9:POPM     d2-d5/a2-a3
+  rts
+
+/**
+ * @fn text_clear
+ * @brief Fill the text area with spaces
+ * @clobber d0-d1/a0-a1
+ * @details Rows which were already empty are not sent again.
+ */
+SUB text_clear
+  PUSHM    d2
+  move.w   text_base, d2
+  lea      text_buffer, a0
+  lea      text_dirty, a1
+  moveq    #TEXT_ROWS - 1, d1
+1:moveq    #0, d0                  // no change in the row yet
+  swap     d1
+  move.w   #TEXT_COLS - 1, d1
+2:cmp.w    (a0), d2
+  beq      3f
+  move.w   d2, (a0)
+  moveq    #1, d0
+3:addq.l   #2, a0
+  dbf      d1, 2b
+  tst.w    d0
+  beq      4f
+  move.w   #TEXT_COLS - 1, (a1)
+4:addq.l   #2, a1
+  swap     d1
+  dbf      d1, 1b
+  POPM     d2
+  rts
+
+/**
+ * @fn text_flush
+ * @brief Queue the changed parts of the text area for DMA
+ * @clobber d0-d1/a0-a1
+ * @details Each row with changes is sent as one transfer, from its first
+ * changed cell to its last. Rows which did not fit in the DMA queue are tried
+ * again on the next flush.
+ */
+SUB text_flush
+  PUSHM    d2-d5/a2
+  lea      text_dirty, a2
+  moveq    #0, d4
+1:moveq    #0, d0
+  move.b   (a2), d0                // first
+  moveq    #0, d2
+  move.b   1(a2), d2               // last
+  cmp.w    d2, d0
+  bhi      2f
+  sub.w    d0, d2
+  addq.w   #1, d2
+  add.w    d0, d0
+
+  move.w   d4, d1
+  mulu.w   #TEXT_COLS * 2, d1
+  add.w    d0, d1
+  addi.l   #text_buffer, d1
+
+  move.w   d4, d5
+  mulu.w   text_stride, d5
+  add.w    text_vram, d0
+  add.w    d5, d0
+  TO_VDPPTR d0
+  ori.l    #VRAM_W, d0
+  move.w   #TEXT_DMA_PRIORITY, d3
+  jsr      dmaq_push
+  bcs      2f
+  move.w   #0xFF00, (a2)
+2:addq.l   #2, a2
+  addq.w   #1, d4
+  cmpi.w   #TEXT_ROWS, d4
+  bne      1b
+  POPM     d2-d5/a2
+  rts
+
+.section .bss
+
+.global text_vram
+text_vram: .word 0
+
+.global text_stride
+text_stride: .word 0
+
+.global text_base
+text_base: .word 0
+
+.global text_dirty
+text_dirty: .space TEXT_ROWS * 2
+
+.global text_buffer
+text_buffer: .space TEXT_COLS * TEXT_ROWS * 2
+
+.align 2
+
+#endif
@@ -239,47 +239,104 @@ static inline u16 to_vram_addr_runtime(vdp_addr vdp_addr)
 
 #define tile_offset(tile_index) ((tile_index) << 5)
 
-// the below is causing weird breakage when compiling...
-/*
-void vdp_dma_fill(
-  vdp_cmd		dest,
-  u16 const count,
-  u8 const	value)
+/**
+ * @fn vdp_dma_wait_c
+ * @ingroup vdp
+ * @brief Wait for a DMA fill or copy to finish
+ * @note Be sure to include vdp.s in your module when using this
+ */
+static inline void vdp_dma_wait_c()
 {
-  register u32 scratch_d, scratch_a;
-
-  // clang-format off
   asm volatile(
     "\
-  lea      (%c[vdp_ctrlport]).l, %[scratch_a] \n\
-  move.l   #0x00940000, %[scratch_d] \n\
-  move.w   %[count].w, %[scratch_d].w \n\
-  lsl.l    #0x8, %[scratch_d] \n\
-  move.w   #0x9300, %[scratch_d].w \n\
-  move.b   %[count].b, %[scratch_d].b \n\
-  move.l   %[scratch_d], (%[scratch_a]) \n\
-  move.w   #0x9780, (%[scratch_a]) \n\
-  ori.l    #0x40000080, %[dest] \n\
-  move.l   %[dest], (%[scratch_a]) \n\
-  move.b   %[value].b, (-0x4,%[scratch_a]) \n\
-0:move.w   (%[scratch_a]), %[scratch_d].w \n\
-  btst.l   0x1, %[scratch_d] \n\
-  bne.b    0b \n\
-    "
-    :
-      [scratch_d] "=&d"(scratch_d),
-      [scratch_a] "=&a"(scratch_a)
+  jsr vdp_dma_wait \n\
+		"
     :
-      [vdp_ctrlport] "i"(VDP_CTRL),
-      [dest] "d"(dest),
-      [count] "d"(count),
-      [value] "d"(value)
     :
-      "cc"
-  );
-  // clang-format on
+    : "cc");
+}
+
+/**
+ * @fn vdp_dma_xfer_c
+ * @ingroup vdp
+ * @brief Copy data from 68000 memory to VRAM, CRAM or VSRAM by DMA
+ * @param source Source address (must be word aligned)
+ * @param dest Destination, e.g. to_vdp_addr(0x2000) | VRAM_W
+ * @param length Length of data (in words)
+ * @details A source which crosses a 128KB boundary is sent in two parts.
+ * @warning Setting/clearing the DMA Enable bit on VDP Mode Register 2 is the
+ * responsibility of the user
+ * @note Be sure to include vdp.s in your module when using this
+ */
+static inline void vdp_dma_xfer_c(void const * source, vdp_cmd dest, u16 length)
+{
+  register u32 d0_dest asm("d0") = dest;
+  register u32 d1_source asm("d1") = (u32) source;
+  register u16 d2_length asm("d2") = length;
+
+  asm volatile(
+    "\
+  jsr vdp_dma_xfer \n\
+		"
+    : "+d"(d0_dest), "+d"(d1_source)
+    : "d"(d2_length)
+    : "cc", "memory");
+}
+
+/**
+ * @fn vdp_dma_fill_c
+ * @ingroup vdp
+ * @brief Fill VRAM, CRAM or VSRAM with a value
+ * @param dest Destination, e.g. to_vdp_addr(0) | VRAM_W
+ * @param count Count (in bytes; 0 fills 64KB of VRAM)
+ * @param value Value to write to each byte
+ * @details VRAM is filled by DMA and CRAM and VSRAM by the CPU, as the VDP
+ * can only fill VRAM. Returns once the fill is done.
+ * @warning Setting/clearing the DMA Enable bit on VDP Mode Register 2 is the
+ * responsibility of the user
+ * @note Be sure to include vdp.s in your module when using this
+ */
+static inline void vdp_dma_fill_c(vdp_cmd dest, u16 count, u8 value)
+{
+  register u32 d0_dest asm("d0") = dest;
+  register u16 d1_count asm("d1") = count;
+  register u8  d2_value asm("d2") = value;
+
+  asm volatile(
+    "\
+  jsr vdp_dma_fill \n\
+		"
+    : "+d"(d0_dest), "+d"(d1_count)
+    : "d"(d2_value)
+    : "cc");
+}
+
+/**
+ * @fn vdp_dma_copy_c
+ * @ingroup vdp
+ * @brief Copy a block of VRAM to another place in VRAM
+ * @param dest Destination address
+ * @param source Source address
+ * @param count Count (in bytes)
+ * @details Returns once the copy is done.
+ * @warning Setting/clearing the DMA Enable bit on VDP Mode Register 2 is the
+ * responsibility of the user
+ * @note Be sure to include vdp.s in your module when using this
+ */
+static inline void vdp_dma_copy_c(vram_addr dest, vram_addr source, u16 count)
+{
+  register u16 d0_dest asm("d0") = dest;
+  register u16 d1_source asm("d1") = source;
+  register u16 d2_count asm("d2") = count;
+
+  asm volatile(
+    "\
+  jsr vdp_dma_copy \n\
+		"
+    : "+d"(d0_dest), "+d"(d1_source)
+    : "d"(d2_count)
+    : "cc");
 }
-*/
 
 /**
  * @fn vdp_dma_transfer
@@ -9,6 +9,8 @@
 #define MEGADEV__MAIN_VDP_S
 
 #include <macros.s>
+#include <main/vdp.def.h>
+#include <main/vdp.macros.s>
 
 /**
  * @fn VDP_DMA_TRANSFER
@@ -20,7 +22,7 @@
  * @warning Enabling/disabling the DMA Enable bit on VDP Mode Register 2 is the responsibility of the user
  */
 SUB VDP_DMA_TRANSFER
-  lea      (vdp_ctrl).l, a6
+  lea      (VDP_CTRL).l, a6
   asr.l    #0x1, d1
   move.l   #0x940000, d3
   move.w   d2, d3
@@ -57,21 +59,169 @@ SUB VDP_DMA_TRANSFER
  * @warning Enabling/disabling the DMA Enable bit on VDP Mode Register 2 is the responsibility of the user
  */
 SUB VDP_DMA_FILL
-  lea      (vdp_ctrl).l,a6
+  lea      (VDP_CTRL).l, a6
   move.l   #0x00940000, d3
-  move.w   d1.w, d3.w
+  move.w   d1, d3
   lsl.l    #0x8, d3
-  move.w   #0x9300, d3.w
-  move.b   d1.b, d3.b
+  move.w   #0x9300, d3
+  move.b   d1, d3
   move.l   d3, (a6)
   move.w   #0x9780, (a6)
   ori.l    #0x40000080, d0
   move.l   d0, (a6)
-  move.b   d2.b, (-0x4,a6)
+  move.b   d2, (-0x4,a6)
   /* wait for DMA in progress flag to clear */
-0:move.w   (a6), d3.w
-  btst.l   0x1, d3
+0:move.w   (a6), d3
+  btst     #1, d3
   bne.b    0b
   rts
 
+/**
+ * @fn vdp_dma_wait
+ * @brief Wait for a DMA fill or copy to finish
+ * @details A transfer from 68000 memory stops the CPU until it is done, but a
+ * fill or a copy runs alongside it, and the VDP ports must not be used until
+ * it has finished.
+ */
+SUB vdp_dma_wait
+1:btst     #1, (VDP_CTRL + 1).l       // VDPSTAT_MASK_DMA_IN_PROGRESS
+  bne      1b
+  rts
+
+/**
+ * @fn vdp_dma_xfer
+ * @brief Copy data from 68000 memory to VRAM, CRAM or VSRAM
+ * @param[in] D0.l Destination address (in vdp_cmd format, with VRAM_W,
+ * CRAM_W or VSRAM_W)
+ * @param[in] D1.l Source address
+ * @param[in] D2.w Length of data (in words)
+ * @clobber d0-d1
+ * @details A source which crosses a 128KB boundary is sent in two parts, as
+ * the VDP source address does not carry past it. The VDP auto increment
+ * must be 2.
+ * @warning Enabling/disabling the DMA Enable bit on VDP Mode Register 2 is the responsibility of the user
+ */
+SUB vdp_dma_xfer
+  PUSHM    d2-d5/a6
+  moveq    #0, d5
+  move.w   d2, d5
+  beq      9f
+
+  // words to the next 128KB boundary of the source
+  move.l   d1, d4
+  andi.l   #0x1FFFF, d4
+  neg.l    d4
+  addi.l   #0x20000, d4
+  lsr.l    #1, d4
+  cmp.l    d4, d5
+  bls      1f
+
+  PUSHM    d0-d1
+  move.w   d4, d2
+  jsr      VDP_DMA_TRANSFER
+  POPM     d0-d1
+  sub.w    d4, d5
+  add.l    d4, d4
+  add.l    d4, d1
+
+  // destination as a 16 bit address, moved forward
+  move.l   d0, d3
+  swap     d3
+  andi.w   #0x3FFF, d3
+  moveq    #3, d2
+  and.w    d0, d2
+  ror.w    #2, d2
+  or.w     d2, d3
+  add.w    d4, d3
+
+  // and back, keeping the operation bits
+  andi.l   #0xC00000F0, d0
+  moveq    #0, d2
+  move.w   d3, d2
+  lsl.l    #2, d2
+  lsr.w    #2, d2
+  swap     d2
+  or.l     d2, d0
+
+1:move.w   d5, d2
+  jsr      VDP_DMA_TRANSFER
+9:POPM     d2-d5/a6
+  rts
+
+/**
+ * @fn vdp_dma_fill
+ * @brief Fill VRAM, CRAM or VSRAM with a value
+ * @param[in] D0.l Destination address (in vdp_cmd format, with VRAM_W,
+ * CRAM_W or VSRAM_W)
+ * @param[in] D1.w Count (in bytes; 0 fills 64KB of VRAM)
+ * @param[in] D2.b Value to write to each byte
+ * @clobber d0-d1
+ * @details VRAM is filled by DMA, and the call returns once the fill is done.
+ * The VDP can only fill VRAM, so CRAM and VSRAM are written by the CPU
+ * instead. The VDP auto increment is left at 2.
+ * @warning Enabling/disabling the DMA Enable bit on VDP Mode Register 2 is the responsibility of the user
+ */
+SUB vdp_dma_fill
+  PUSHM    d2-d3/a6
+  move.l   d0, d3
+  andi.l   #0x80000010, d3         // CRAM or VSRAM
+  bne      1f
+  move.w   #VDP_REG_AUTOINC | 1, (VDP_CTRL).l
+  jsr      VDP_DMA_FILL
+  move.w   #VDP_REG_AUTOINC | 2, (VDP_CTRL).l
+  bra      9f
+
+1:move.l   d0, (VDP_CTRL).l
+  move.b   d2, d3
+  lsl.w    #8, d3
+  move.b   d2, d3
+  lsr.w    #1, d1
+  subq.w   #1, d1
+  bcs      9f
+2:move.w   d3, (VDP_DATA).l
+  dbf      d1, 2b
+9:POPM     d2-d3/a6
+  rts
+
+/**
+ * @fn vdp_dma_copy
+ * @brief Copy a block of VRAM to another place in VRAM
+ * @param[in] D0.w Destination address
+ * @param[in] D1.w Source address
+ * @param[in] D2.w Count (in bytes)
+ * @clobber d0-d1
+ * @details Returns once the copy is done. The VDP auto increment is left at
+ * 2.
+ * @warning Enabling/disabling the DMA Enable bit on VDP Mode Register 2 is the responsibility of the user
+ */
+SUB vdp_dma_copy
+  PUSHM    d3/a6
+  tst.w    d2
+  beq      9f
+  lea      (VDP_CTRL).l, a6
+  move.w   #VDP_REG_AUTOINC | 1, (a6)
+  move.w   #VDP_REG_DMA_SZ1, d3
+  move.b   d2, d3
+  move.w   d3, (a6)
+  move.w   d2, d3
+  lsr.w    #8, d3
+  ori.w    #VDP_REG_DMA_SZ2, d3
+  move.w   d3, (a6)
+  move.w   #VDP_REG_DMA_SRC1, d3
+  move.b   d1, d3
+  move.w   d3, (a6)
+  move.w   d1, d3
+  lsr.w    #8, d3
+  ori.w    #VDP_REG_DMA_SRC2, d3
+  move.w   d3, (a6)
+  move.w   #VDP_REG_DMA_SRC3 | 0xC0, (a6)   // VRAM copy
+  TO_VDPPTR d0
+  ori.l    #0x000000C0, d0
+  move.l   d0, (a6)
+1:btst     #1, (1, a6)                // VDPSTAT_MASK_DMA_IN_PROGRESS
+  bne      1b
+  move.w   #VDP_REG_AUTOINC | 2, (a6)
+9:POPM     d3/a6
+  rts
+
 #endif
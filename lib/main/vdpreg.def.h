@@ -0,0 +1,19 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/vdpreg.def.h
+ * @brief Shadow VDP register definitions
+ */
+
+#ifndef MEGADEV__MAIN_VDPREG_DEF_H
+#define MEGADEV__MAIN_VDPREG_DEF_H
+
+/**
+ * @def VDPREG_COUNT
+ * @brief Number of registers in the shadow (0x00 to 0x12)
+ * @details The DMA registers (0x13 to 0x17) are set with each transfer and
+ * are not kept.
+ */
+#define VDPREG_COUNT 19
+
+#endif
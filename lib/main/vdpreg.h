@@ -0,0 +1,142 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/vdpreg.h
+ * @brief Shadow VDP registers
+ *
+ * @details
+ * The VDP registers cannot be read back, so a copy of their values is kept
+ * in RAM. Changes are made to the copy and marked in a dirty mask, and
+ * @ref vdpreg_flush_c (called from the VBlank handler) writes only the
+ * registers which changed, two at a time.
+ *
+ *   vdpreg_load(default_vdp_regs, 17);
+ *   vdpreg_flush_c();
+ *
+ *   // during the frame
+ *   vdpreg_set(VDP_REG_BGCOLOR, 0x12);
+ *   vdpreg_set_bits(VDP_REG_MODE2, VDP_DISPLAY_ENABLE);
+ *
+ *   // in the VBlank handler
+ *   vdpreg_flush_c();
+ *
+ * Registers are named by their VDP_REGxx value (e.g. VDP_REG_MODE2). Only
+ * registers 0x00 to 0x12 are kept; the DMA registers are set with each
+ * transfer.
+ *
+ * For changes which must take effect right away, such as setting the DMA
+ * Enable bit before a transfer, use @ref vdpreg_write.
+ *
+ * @note The Boot ROM library keeps its own cache (BIOS_VDP_REG_CACHE), which
+ * is not updated by these. Use one or the other for a given register.
+ *
+ * Be sure to include vdpreg_main.s in your module when using these.
+ */
+
+#ifndef MEGADEV__MAIN_VDPREG_H
+#define MEGADEV__MAIN_VDPREG_H
+
+#include "main/vdp.h"
+#include "main/vdpreg.def.h"
+#include "types.h"
+
+/**
+ * @var vdpreg_shadow
+ * @brief Last value set for each register
+ */
+extern u8 vdpreg_shadow[VDPREG_COUNT];
+
+/**
+ * @var vdpreg_dirty
+ * @brief Registers changed since the last flush, one bit per register
+ */
+extern u32 volatile vdpreg_dirty;
+
+#define vdpreg_index(reg) (((reg) >> 8) & 0x1F)
+
+/**
+ * @fn vdpreg_get
+ * @brief Value of a register from the shadow
+ * @param reg Register (VDP_REGxx)
+ */
+static inline u8 vdpreg_get(vdp_reg reg)
+{
+  return vdpreg_shadow[vdpreg_index(reg)];
+}
+
+/**
+ * @fn vdpreg_set
+ * @brief Change a register, to be written on the next flush
+ * @param reg Register (VDP_REGxx)
+ * @param value New value
+ */
+static inline void vdpreg_set(vdp_reg reg, u8 value)
+{
+  vdpreg_shadow[vdpreg_index(reg)] = value;
+  vdpreg_dirty |= 1UL << vdpreg_index(reg);
+}
+
+/**
+ * @fn vdpreg_set_bits
+ * @brief Set bits in a register, to be written on the next flush
+ */
+static inline void vdpreg_set_bits(vdp_reg reg, u8 mask)
+{
+  vdpreg_set(reg, vdpreg_get(reg) | mask);
+}
+
+/**
+ * @fn vdpreg_clear_bits
+ * @brief Clear bits in a register, to be written on the next flush
+ */
+static inline void vdpreg_clear_bits(vdp_reg reg, u8 mask)
+{
+  vdpreg_set(reg, vdpreg_get(reg) & ~mask);
+}
+
+/**
+ * @fn vdpreg_write
+ * @brief Change a register and write it to the VDP right away
+ * @param reg Register (VDP_REGxx)
+ * @param value New value
+ */
+static inline void vdpreg_write(vdp_reg reg, u8 value)
+{
+  vdpreg_shadow[vdpreg_index(reg)] = value;
+  vdpreg_dirty &= ~(1UL << vdpreg_index(reg));
+  vdp_ctrl = (reg & 0xFF00) | value;
+}
+
+/**
+ * @fn vdpreg_load
+ * @brief Set several registers from a list of VDP_REGxx | value words
+ * @param regs Pointer to the list
+ * @param count Number of entries in the list
+ * @details All of the registers in the list are written on the next flush.
+ */
+static inline void vdpreg_load(vdp_reg const * regs, u16 count)
+{
+  while (count--)
+  {
+    vdpreg_set(*regs, (u8) *regs);
+    ++regs;
+  }
+}
+
+/**
+ * @fn vdpreg_flush_c
+ * @brief Write the changed registers to the VDP
+ * @note Meant to be called from the VBlank handler
+ */
+static inline void vdpreg_flush_c()
+{
+  asm volatile(
+    "\
+  jsr vdpreg_flush \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+#endif
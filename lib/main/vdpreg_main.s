@@ -0,0 +1,70 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/vdpreg_main.s
+ * @brief Shadow VDP registers
+ *
+ * @details
+ * See main/vdpreg.h for usage.
+ */
+
+#ifndef MEGADEV__MAIN_VDPREG_S
+#define MEGADEV__MAIN_VDPREG_S
+
+#include <macros.s>
+#include <main/vdp.def.h>
+#include <main/vdpreg.def.h>
+
+.section .text
+
+/**
+ * @fn vdpreg_flush
+ * @brief Write the changed shadow registers to the VDP
+ * @clobber d0-d1/a0-a1
+ * @details Registers are written two at a time with 32 bit writes to the
+ * control port, in order of register number. Meant to be called from the
+ * VBlank handler.
+ */
+SUB vdpreg_flush
+  move.l   vdpreg_dirty, d0
+  beq      9f
+  clr.l    vdpreg_dirty
+  move.l   d2, -(sp)
+  lea      vdpreg_shadow, a0
+  lea      (VDP_CTRL).l, a1
+  move.w   #VDP_REG00, d1
+  moveq    #0, d2                  // register waiting for a pair, if not 0
+
+0:lsr.l    #1, d0
+  bcc      2f
+  move.b   (a0), d1
+  tst.w    d2
+  bne      1f
+  move.w   d1, d2
+  bra      2f
+1:swap     d2
+  move.w   d1, d2
+  move.l   d2, (a1)
+  moveq    #0, d2
+2:addq.l   #1, a0
+  addi.w   #0x100, d1
+  tst.l    d0
+  bne      0b
+
+  tst.w    d2
+  beq      3f
+  move.w   d2, (a1)
+3:move.l   (sp)+, d2
+9:rts
+
+.section .bss
+
+.global vdpreg_dirty
+vdpreg_dirty: .long 0
+
+.global vdpreg_shadow
+vdpreg_shadow: .space VDPREG_COUNT
+
+.align 2
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/vram.def.h
+ * @brief VRAM tile allocator definitions
+ *
+ * @details
+ * Free tiles are kept as a list of ranges, in order of their first tile:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | word | First tile
+ * 0x02   | word | Number of tiles
+ *
+ * Shared tile sets are kept in a table:
+ *
+ * Offset | Size | Contents
+ * -------|------|---------
+ * 0x00   | long | Source address, which identifies the set (0 if unused)
+ * 0x04   | word | First tile
+ * 0x06   | word | Number of tiles
+ * 0x08   | word | Reference count
+ */
+
+#ifndef MEGADEV__MAIN_VRAM_DEF_H
+#define MEGADEV__MAIN_VRAM_DEF_H
+
+#define VRAM_RANGE_FIRST 0x00
+#define VRAM_RANGE_COUNT 0x02
+#define VRAM_RANGE_SIZE  4
+
+#define VRAM_SET_SOURCE 0x00
+#define VRAM_SET_FIRST  0x04
+#define VRAM_SET_COUNT  0x06
+#define VRAM_SET_REFS   0x08
+#define VRAM_SET_SIZE   10
+
+/**
+ * @def VRAM_RANGES
+ * @brief Largest number of separate free ranges
+ */
+#ifndef VRAM_RANGES
+#define VRAM_RANGES 32
+#endif
+
+/**
+ * @def VRAM_SETS
+ * @brief Largest number of shared tile sets
+ */
+#ifndef VRAM_SETS
+#define VRAM_SETS 16
+#endif
+
+/**
+ * @def VRAM_DMA_PRIORITY
+ * @brief Priority of shared tile set uploads in the DMA queue
+ */
+#ifndef VRAM_DMA_PRIORITY
+#define VRAM_DMA_PRIORITY 2
+#endif
+
+#endif
@@ -0,0 +1,208 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/vram.h
+ * @brief VRAM tile allocator
+ *
+ * @details
+ * Keeps track of which tiles in VRAM are free, so that graphics can be loaded
+ * and unloaded as objects come and go instead of being placed at fixed
+ * addresses.
+ *
+ *   vram_init_c();
+ *   // everything from tile 1 up to the sprite table
+ *   vram_free_c(1, (0xB800 / 32) - 1);
+ *
+ *   u16 bg_tiles = vram_alloc_c(bg_tile_count);
+ *   if (bg_tiles == VRAM_NONE)
+ *     ...
+ *
+ * Tile sets used by several objects (e.g. every enemy of the same kind) can
+ * be shared. The first vram_share_c for a set allocates its tiles and queues
+ * it for upload through the DMA queue (see main/dmaq.h); the following ones
+ * only increase its reference count. Each vram_share_c is matched with a
+ * vram_release_c, and the tiles are freed after the last one.
+ *
+ *   u16 tile = vram_share_c(enemy_chr, ENEMY_TILES);
+ *   ...
+ *   vram_release_c(enemy_chr);
+ *
+ * Animations which only need one frame in VRAM at a time can allocate tiles
+ * for the largest frame and stream each new frame into them with
+ * vram_upload_c.
+ *
+ * Free ranges next to each other are merged as tiles are freed. The largest
+ * range which can be allocated may still be smaller than vram_free_tiles if
+ * the free tiles are scattered.
+ *
+ * Be sure to include vram_main.s in your module when using these, as well as
+ * dmaq_main.s and vdp.s when using shared sets or vram_upload_c.
+ */
+
+#ifndef MEGADEV__MAIN_VRAM_H
+#define MEGADEV__MAIN_VRAM_H
+
+#include "main/dmaq.h"
+#include "main/vram.def.h"
+#include "types.h"
+
+/**
+ * @def VRAM_NONE
+ * @brief Returned in place of a tile index when there is no room
+ */
+#define VRAM_NONE 0xFFFF
+
+/**
+ * @var vram_free_tiles
+ * @brief Total number of free tiles
+ */
+extern u16 volatile vram_free_tiles;
+
+/**
+ * @var vram_range_count
+ * @brief Number of separate free ranges
+ */
+extern u16 volatile vram_range_count;
+
+/**
+ * @fn vram_init_c
+ * @brief Empty the allocator
+ * @details No tiles are free afterward; hand the tiles to be managed to the
+ * allocator with @ref vram_free_c.
+ */
+static inline void vram_init_c()
+{
+  asm volatile(
+    "\
+  jsr vram_init \n\
+		"
+    :
+    :
+    : "d0", "a0", "cc", "memory");
+}
+
+/**
+ * @fn vram_alloc_c
+ * @brief Allocate a contiguous range of tiles
+ * @param count Number of tiles
+ * @return Index of the first tile, or VRAM_NONE if no free range is large
+ * enough
+ */
+static inline u16 vram_alloc_c(u16 count)
+{
+  register u16 d0_count asm("d0") = count;
+
+  asm volatile(
+    "\
+  jsr vram_alloc \n\
+  bcc 1f \n\
+  move.w #0xFFFF, %[count] \n\
+1: \n\
+		"
+    : [count] "+d"(d0_count)
+    :
+    : "d1", "a0", "a1", "cc", "memory");
+
+  return d0_count;
+}
+
+/**
+ * @fn vram_free_c
+ * @brief Return a range of tiles to the allocator
+ * @param first Index of the first tile
+ * @param count Number of tiles
+ * @return false if the free list was full and the tiles were lost
+ */
+static inline bool vram_free_c(u16 first, u16 count)
+{
+  register u16 d0_first asm("d0") = first;
+  register u16 d1_count asm("d1") = count;
+  register u8  result;
+
+  asm volatile(
+    "\
+  jsr vram_free \n\
+  scc %[result] \n\
+		"
+    : "+d"(d0_first), "+d"(d1_count), [result] "=d"(result)
+    :
+    : "a0", "a1", "cc", "memory");
+
+  return result;
+}
+
+/**
+ * @fn vram_share_c
+ * @brief Get the tiles of a shared tile set, loading it if needed
+ * @param source Tile data, which also identifies the set
+ * @param count Number of tiles
+ * @return Index of the first tile, or VRAM_NONE if there was no room for the
+ * set in VRAM, in the set table or in the DMA queue
+ * @note A newly loaded set is in VRAM once its queued transfer completes,
+ * which may take more than one flush of the DMA queue for a large set (see
+ * dmaq_deferred)
+ */
+static inline u16 vram_share_c(void const * source, u16 count)
+{
+  register u32 a0_source asm("a0") = (u32) source;
+  register u16 d0_count asm("d0") = count;
+
+  asm volatile(
+    "\
+  jsr vram_share \n\
+  bcc 1f \n\
+  move.w #0xFFFF, %[count] \n\
+1: \n\
+		"
+    : "+a"(a0_source), [count] "+d"(d0_count)
+    :
+    : "d1", "a1", "cc", "memory");
+
+  return d0_count;
+}
+
+/**
+ * @fn vram_release_c
+ * @brief Drop a reference to a shared tile set
+ * @param source Tile data, as given to @ref vram_share_c
+ * @return false if the set was not loaded
+ * @details If the free list is full when the last reference is dropped, the
+ * set stays in VRAM and is used again by the next @ref vram_share_c for it.
+ */
+static inline bool vram_release_c(void const * source)
+{
+  register u32 a0_source asm("a0") = (u32) source;
+  register u8  result;
+
+  asm volatile(
+    "\
+  jsr vram_release \n\
+  scc %[result] \n\
+		"
+    : "+a"(a0_source), [result] "=d"(result)
+    :
+    : "d0", "d1", "a1", "cc", "memory");
+
+  return result;
+}
+
+/**
+ * @fn vram_upload_c
+ * @brief Queue tiles for upload to allocated tiles
+ * @param tile Index of the first tile
+ * @param source Tile data
+ * @param count Number of tiles
+ * @return false if the DMA queue was full
+ * @details For streaming animation frames into the same tiles. The frames
+ * are sent whole, so that a frame is never shown half updated.
+ */
+static inline bool vram_upload_c(u16 tile, void const * source, u16 count)
+{
+  return dmaq_push_c(source,
+    to_vdp_addr(tile_offset(tile)) | VRAM_W,
+    count << 4,
+    VRAM_DMA_PRIORITY,
+    DMAQ_FLAG_WHOLE);
+}
+
+#endif
@@ -0,0 +1,291 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file main/vram_main.s
+ * @brief VRAM tile allocator
+ *
+ * @details
+ * See vram.def.h for the list formats and main/vram.h for usage. Shared tile
+ * sets are uploaded through the DMA queue, so dmaq_main.s and vdp.s must be
+ * included in the module when using them.
+ */
+
+#ifndef MEGADEV__MAIN_VRAM_S
+#define MEGADEV__MAIN_VRAM_S
+
+#include <macros.s>
+#include <main/dmaq.def.h>
+#include <main/vdp.def.h>
+#include <main/vdp.macros.s>
+#include <main/vram.def.h>
+
+.section .text
+
+/**
+ * @fn vram_init
+ * @brief Empty the allocator
+ * @clobber d0/a0
+ * @details No tiles are free afterward; hand the tiles to be managed to the
+ * allocator with vram_free.
+ */
+SUB vram_init
+  clr.w    vram_range_count
+  clr.w    vram_free_tiles
+  lea      vram_sets, a0
+  moveq    #VRAM_SETS - 1, d0
+0:clr.l    (a0)
+  lea      VRAM_SET_SIZE(a0), a0
+  dbf      d0, 0b
+  rts
+
+/**
+ * @fn vram_alloc
+ * @brief Allocate a contiguous range of tiles
+ * @param[in] D0.w Number of tiles
+ * @param[out] D0.w First tile
+ * @param[out] CC Tiles allocated
+ * @param[out] CS No free range is large enough
+ * @clobber d1/a0-a1
+ * @details The first free range which is large enough is used, from its
+ * start.
+ */
+SUB vram_alloc
+  tst.w    d0
+  beq      9f
+  lea      vram_ranges, a0
+  move.w   vram_range_count, d1
+  bra      2f
+1:cmp.w    VRAM_RANGE_COUNT(a0), d0
+  bls      3f
+  addq.l   #VRAM_RANGE_SIZE, a0
+2:dbf      d1, 1b
+9:move     #1, ccr
+  rts
+
+3:movea.w  VRAM_RANGE_FIRST(a0), a1
+  sub.w    d0, vram_free_tiles
+  add.w    d0, VRAM_RANGE_FIRST(a0)
+  sub.w    d0, VRAM_RANGE_COUNT(a0)
+  bne      5f
+
+  // the range is used up
+  subq.w   #1, vram_range_count
+  bra      4f
+6:move.l   VRAM_RANGE_SIZE(a0), (a0)+
+4:dbf      d1, 6b
+
+5:move.w   a1, d0
+  move     #0, ccr
+  rts
+
+/**
+ * @fn vram_free
+ * @brief Return a range of tiles to the allocator
+ * @param[in] D0.w First tile
+ * @param[in] D1.w Number of tiles
+ * @param[out] CC Tiles freed
+ * @param[out] CS The free list is full (see VRAM_RANGES); the tiles are lost
+ * @clobber d0-d1/a0-a1
+ * @details The range is merged with the free ranges directly before and
+ * after it. It must not overlap a range which is already free.
+ */
+SUB vram_free
+  tst.w    d1
+  beq      8f
+  PUSHM    d2-d4
+
+  // find the first range after this one
+  lea      vram_ranges, a0
+  move.w   vram_range_count, d2
+  bra      2f
+1:cmp.w    VRAM_RANGE_FIRST(a0), d0
+  bcs      3f
+  addq.l   #VRAM_RANGE_SIZE, a0
+2:dbf      d2, 1b
+  // d2 is now one less than the number of ranges from a0 onward
+
+3:move.w   d0, d4
+  add.w    d1, d4                  // end of the freed tiles
+  cmpa.l   #vram_ranges, a0
+  beq      5f
+  move.w   (-VRAM_RANGE_SIZE + VRAM_RANGE_FIRST, a0), d3
+  add.w    (-VRAM_RANGE_SIZE + VRAM_RANGE_COUNT, a0), d3
+  cmp.w    d3, d0
+  bne      5f
+
+  // follows the previous range
+  add.w    d1, (-VRAM_RANGE_SIZE + VRAM_RANGE_COUNT, a0)
+  tst.w    d2
+  bmi      7f
+  cmp.w    VRAM_RANGE_FIRST(a0), d4
+  bne      7f
+
+  // and fills the gap to the next one
+  move.w   VRAM_RANGE_COUNT(a0), d3
+  add.w    d3, (-VRAM_RANGE_SIZE + VRAM_RANGE_COUNT, a0)
+  subq.w   #1, vram_range_count
+  bra      41f
+40:move.l  VRAM_RANGE_SIZE(a0), (a0)+
+41:dbf     d2, 40b
+  bra      7f
+
+  // precedes the next range
+5:tst.w    d2
+  bmi      6f
+  cmp.w    VRAM_RANGE_FIRST(a0), d4
+  bne      6f
+  move.w   d0, VRAM_RANGE_FIRST(a0)
+  add.w    d1, VRAM_RANGE_COUNT(a0)
+  bra      7f
+
+  // a new range
+6:cmpi.w   #VRAM_RANGES, vram_range_count
+  bcc      9f
+  addq.w   #1, d2                  // ranges to move up
+  move.w   d2, d3
+  lsl.w    #2, d3
+  lea      (a0,d3.w), a1
+  bra      61f
+60:move.l  -(a1), VRAM_RANGE_SIZE(a1)
+61:dbf     d2, 60b
+  move.w   d0, VRAM_RANGE_FIRST(a0)
+  move.w   d1, VRAM_RANGE_COUNT(a0)
+  addq.w   #1, vram_range_count
+
+7:add.w    d1, vram_free_tiles
+  POPM     d2-d4
+8:move     #0, ccr
+  rts
+
+9:POPM     d2-d4
+  move     #1, ccr
+  rts
+
+/**
+ * @fn vram_share
+ * @brief Get the tiles of a shared tile set, loading it if needed
+ * @param[in] A0.l Pointer to the tile data, which identifies the set
+ * @param[in] D0.w Number of tiles
+ * @param[out] D0.w First tile
+ * @param[out] CC The set is available
+ * @param[out] CS No room for the set in VRAM, in the set table or in the
+ * DMA queue
+ * @clobber d1/a0-a1
+ * @details If the set is already in VRAM, its reference count is increased.
+ * Otherwise tiles are allocated for it and it is queued for upload, so it is
+ * in VRAM once the queued transfer completes. A large set may be sent over
+ * more than one flush of the DMA queue.
+ */
+SUB vram_share
+  PUSHM    d2-d5/a2
+  move.l   a0, d4                  // source
+  move.w   d0, d5                  // count
+
+  lea      vram_sets, a1
+  suba.l   a2, a2                  // first unused entry
+  moveq    #VRAM_SETS - 1, d2
+1:move.l   VRAM_SET_SOURCE(a1), d1
+  bne      2f
+  move.l   a2, d3
+  bne      3f
+  movea.l  a1, a2
+  bra      3f
+2:cmp.l    d4, d1
+  bne      3f
+  addq.w   #1, VRAM_SET_REFS(a1)
+  move.w   VRAM_SET_FIRST(a1), d0
+  bra      8f
+3:lea      VRAM_SET_SIZE(a1), a1
+  dbf      d2, 1b
+
+  // not loaded yet
+  move.l   a2, d1
+  beq      9f
+  move.w   d5, d0
+  bsr      vram_alloc
+  bcs      9f
+  move.l   d4, VRAM_SET_SOURCE(a2)
+  move.w   d0, VRAM_SET_FIRST(a2)
+  move.w   d5, VRAM_SET_COUNT(a2)
+  move.w   #1, VRAM_SET_REFS(a2)
+
+  moveq    #0, d0
+  move.w   VRAM_SET_FIRST(a2), d0
+  lsl.l    #5, d0
+  TO_VDPPTR d0
+  ori.l    #VRAM_W, d0
+  move.l   d4, d1
+  move.w   d5, d2
+  lsl.w    #4, d2                  // 16 words per tile
+  move.w   #VRAM_DMA_PRIORITY, d3
+  jsr      dmaq_push
+  bcc      7f
+
+  // no room in the queue, so give the tiles back
+  clr.l    VRAM_SET_SOURCE(a2)
+  move.w   VRAM_SET_FIRST(a2), d0
+  move.w   d5, d1
+  bsr      vram_free
+  bra      9f
+
+7:move.w   VRAM_SET_FIRST(a2), d0
+8:POPM     d2-d5/a2
+  move     #0, ccr
+  rts
+
+9:POPM     d2-d5/a2
+  move     #1, ccr
+  rts
+
+/**
+ * @fn vram_release
+ * @brief Drop a reference to a shared tile set
+ * @param[in] A0.l Pointer to the tile data, as given to vram_share
+ * @param[out] CC Reference dropped
+ * @param[out] CS The set is not loaded
+ * @clobber d0-d1/a0-a1
+ * @details The tiles are freed once the last reference is dropped. If the
+ * free list is full, the set is instead left in VRAM with no references, and
+ * is used again by the next vram_share for it rather than being lost.
+ */
+SUB vram_release
+  move.l   a0, d0
+  beq      9f
+  lea      vram_sets, a1
+  moveq    #VRAM_SETS - 1, d1
+1:cmp.l    VRAM_SET_SOURCE(a1), d0
+  beq      2f
+  lea      VRAM_SET_SIZE(a1), a1
+  dbf      d1, 1b
+9:move     #1, ccr
+  rts
+
+2:subq.w   #1, VRAM_SET_REFS(a1)
+  bne      3f
+  move.w   VRAM_SET_FIRST(a1), d0
+  move.w   VRAM_SET_COUNT(a1), d1
+  move.l   a1, -(sp)
+  bsr      vram_free
+  movea.l  (sp)+, a1
+  bcs      3f                      // free list full, so keep the set
+  clr.l    VRAM_SET_SOURCE(a1)
+3:move     #0, ccr
+  rts
+
+.section .bss
+
+.global vram_ranges
+vram_ranges: .space VRAM_RANGES * VRAM_RANGE_SIZE
+
+.global vram_sets
+vram_sets: .space VRAM_SETS * VRAM_SET_SIZE
+
+.global vram_range_count
+vram_range_count: .word 0
+
+.global vram_free_tiles
+vram_free_tiles: .word 0
+
+.align 2
+
+#endif
@@ -8,6 +8,25 @@
  * been divided based on the size of the values on which the operation will be
  * performed. This is to optimize their use and it will be up to the developer
  * to determine which call should be used for their purpose.
+ *
+ * For large ranges, use memset_block_c/memcpy_block_c (from memory.s), which
+ * move 32 bytes per iteration with MOVEM. Be sure to include memory.s in your
+ * module when using them.
+ *
+ * Approximate cost per byte, from the 68000 instruction timings (no wait
+ * states; setup and tail not included):
+ *
+ * | Call           | Fill (cycles/byte) | Copy (cycles/byte) |
+ * |:---------------|-------------------:|-------------------:|
+ * | *8             | 18.0               | 22.0               |
+ * | *16            | 9.0                | 11.0               |
+ * | *32            | 5.5                | 7.5                |
+ * | *_block_c      | 2.6                | 5.2                |
+ *
+ * For example, clearing all of 2M Word RAM (256KB) takes about 1.44M cycles
+ * with memset32 and about 0.67M cycles with memset_block_c. The block calls
+ * have a fixed setup cost of roughly 200 cycles, so they are only worth using
+ * for ranges of a few hundred bytes or more.
  */
 
 #ifndef MEGADEV__MEMORY_H
@@ -21,11 +40,17 @@
  */
 static inline void memset8(u8 value, void * dest, u32 length)
 {
+  if (length == 0)
+    return;
   --length;
   asm volatile(
     "\
+  bra 1f \n\
+0:swap %[length] \n\
 1:move.b %[value], (%[dest])+ \n\
   dbf %[length], 1b \n\
+  swap %[length] \n\
+  dbf %[length], 0b \n\
 		"
     : [dest] "+a"(dest), [length] "+d"(length)
     : [value] "d"(value)
@@ -38,11 +63,17 @@ static inline void memset8(u8 value, void * dest, u32 length)
  */
 static inline void memset16(u16 value, void * dest, u32 length)
 {
+  if (length == 0)
+    return;
   --length;
   asm volatile(
     "\
+  bra 1f \n\
+0:swap %[length] \n\
 1:move.w %[value], (%[dest])+ \n\
   dbf %[length], 1b \n\
+  swap %[length] \n\
+  dbf %[length], 0b \n\
 		"
     : [dest] "+a"(dest), [length] "+d"(length)
     : [value] "d"(value)
@@ -55,11 +86,17 @@ static inline void memset16(u16 value, void * dest, u32 length)
  */
 static inline void memset32(u32 value, void * dest, u32 length)
 {
+  if (length == 0)
+    return;
   --length;
   asm volatile(
     "\
+  bra 1f \n\
+0:swap %[length] \n\
 1:move.l %[value], (%[dest])+ \n\
   dbf %[length], 1b \n\
+  swap %[length] \n\
+  dbf %[length], 0b \n\
 		"
     : [dest] "+a"(dest), [length] "+d"(length)
     : [value] "d"(value)
@@ -72,11 +109,17 @@ static inline void memset32(u32 value, void * dest, u32 length)
  */
 static inline void memcpy8(u8 * src, u8 * dest, u32 length)
 {
+  if (length == 0)
+    return;
   --length;
   asm volatile(
     "\
+  bra 1f \n\
+0:swap %[length] \n\
 1:move.b (%[src])+, (%[dest])+ \n\
   dbf %[length], 1b \n\
+  swap %[length] \n\
+  dbf %[length], 0b \n\
 		"
     : [src] "+a"(src), [dest] "+a"(dest), [length] "+d"(length)
     :
@@ -89,11 +132,17 @@ static inline void memcpy8(u8 * src, u8 * dest, u32 length)
  */
 static inline void memcpy16(u16 const * src, u16 * dest, u32 length)
 {
+  if (length == 0)
+    return;
   --length;
   asm volatile(
     "\
+  bra 1f \n\
+0:swap %[length] \n\
 1:move.w (%[src])+, (%[dest])+ \n\
   dbf %[length], 1b \n\
+  swap %[length] \n\
+  dbf %[length], 0b \n\
 		"
     : [src] "+a"(src), [dest] "+a"(dest), [length] "+d"(length)
     :
@@ -106,17 +155,64 @@ static inline void memcpy16(u16 const * src, u16 * dest, u32 length)
  */
 static inline void memcpy32(u32 const * src, u32 * dest, u32 length)
 {
+  if (length == 0)
+    return;
   --length;
   asm volatile(
     "\
+  bra 1f \n\
+0:swap %[length] \n\
 1:move.l (%[src])+, (%[dest])+ \n\
   dbf %[length], 1b \n\
+  swap %[length] \n\
+  dbf %[length], 0b \n\
 		"
     : [src] "+a"(src), [dest] "+a"(dest), [length] "+d"(length)
     :
     : "cc");
 }
 
+/**
+ * @fn memset_block_c
+ * @brief Fill a range of memory with an 8-bit value, 32 bytes at a time
+ * @param length Length in bytes
+ */
+static inline void memset_block_c(u8 value, void * dest, u32 length)
+{
+  register u32 d0_length asm("d0") = length;
+  register u8  d1_value asm("d1") = value;
+  register u32 a0_dest asm("a0") = (u32) dest;
+
+  asm volatile(
+    "\
+  jsr memset_block \n\
+		"
+    : "+d"(d0_length), "+d"(d1_value), "+a"(a0_dest)
+    :
+    : "a1", "cc", "memory");
+}
+
+/**
+ * @fn memcpy_block_c
+ * @brief Copy a range of memory, 32 bytes at a time
+ * @param length Length in bytes
+ * @note Falls back to a byte copy if the alignment of src and dest differ
+ */
+static inline void memcpy_block_c(void const * src, void * dest, u32 length)
+{
+  register u32 d0_length asm("d0") = length;
+  register u32 a0_src asm("a0") = (u32) src;
+  register u32 a1_dest asm("a1") = (u32) dest;
+
+  asm volatile(
+    "\
+  jsr memcpy_block \n\
+		"
+    : "+d"(d0_length), "+a"(a0_src), "+a"(a1_dest)
+    :
+    : "d1", "cc", "memory");
+}
+
 void strcpy(char * dest, const char * src)
 {
   while ((*dest = *src) != '\0')
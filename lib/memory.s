@@ -0,0 +1,159 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file memory.s
+ * @brief Block memory fill and copy routines
+ *
+ * @details
+ * These are intended for large transfers, where the setup cost is quickly paid
+ * back by moving 32 bytes per loop iteration with MOVEM. Lengths are in bytes
+ * and the full 32 bits are honored. Short lengths fall back to a simple byte
+ * loop.
+ *
+ * Blocks are 32 bytes (rather than 48) so that the block count and the tail
+ * can be calculated with a shift and a mask instead of a divide.
+ */
+
+#include "macros.s"
+
+.section .text
+
+/**
+ * @fn memset_block
+ * @brief Fill a range of memory with an 8 bit value
+ * @param[in] A0.l Pointer to destination
+ * @param[in] D0.l Length (in bytes)
+ * @param[in] D1.b Value
+ * @clobber d0-d1/a0-a1
+ */
+SUB memset_block
+  cmpi.l   #32, d0
+  bcc      1f
+  // short fill, not worth the setup below
+  subq.w   #1, d0
+  bcs      9f
+0:move.b   d1, (a0)+
+  dbf      d0, 0b
+9:rts
+
+1:PUSHM    d2-d7/a2
+  // replicate the value across the full longword
+  andi.l   #0xFF, d1
+  move.l   d1, d2
+  lsl.w    #8, d2
+  or.w     d2, d1
+  move.w   d1, d2
+  swap     d1
+  move.w   d2, d1
+  // make sure the destination is word aligned
+  move.w   a0, d2
+  btst     #0, d2
+  beq      2f
+  move.b   d1, (a0)+
+  subq.l   #1, d0
+  // MOVEM can only write with predecrement, so we fill from the end down
+  // to the (now aligned) start, taking care of the tail first
+2:adda.l   d0, a0
+  btst     #0, d0
+  beq      3f
+  move.b   d1, -(a0)
+3:btst     #1, d0
+  beq      4f
+  move.w   d1, -(a0)
+4:move.w   d0, d2
+  lsr.w    #2, d2
+  andi.w   #7, d2
+  bra      6f
+5:move.l   d1, -(a0)
+6:dbf      d2, 5b
+  // and now the 32 byte blocks
+  lsr.l    #5, d0
+  beq      9f
+  move.l   d1, d2
+  move.l   d1, d3
+  move.l   d1, d4
+  move.l   d1, d5
+  move.l   d1, d6
+  move.l   d1, d7
+  movea.l  d1, a2
+  subq.l   #1, d0
+7:movem.l  d1-d7/a2, -(a0)
+  dbf      d0, 7b
+  // dbf only counts the lower word; use the upper word as an outer counter
+  swap     d0
+  dbf      d0, 8f
+  bra      9f
+8:swap     d0
+  bra      7b
+9:POPM     d2-d7/a2
+  rts
+
+/**
+ * @fn memcpy_block
+ * @brief Copy a range of memory
+ * @param[in] A0.l Pointer to source
+ * @param[in] A1.l Pointer to destination
+ * @param[in] D0.l Length (in bytes)
+ * @clobber d0-d1/a0-a1
+ * @note Source and destination must not overlap
+ * @note If the source and destination do not have the same alignment (i.e.
+ * one is odd and the other is even), the copy falls back to bytes as the
+ * 68000 cannot do word access on odd addresses
+ */
+SUB memcpy_block
+  cmpi.l   #32, d0
+  bcs      memcpy_block_bytes
+
+  // source and destination must be both odd or both even to use long moves
+  // (bit 0 of the sum of the two addresses is set when they differ)
+  move.w   a0, d1
+  add.w    a1, d1
+  btst     #0, d1
+  bne      memcpy_block_bytes
+
+  PUSHM    d2-d7/a2-a3
+  move.w   a0, d1
+  btst     #0, d1
+  beq      1f
+  move.b   (a0)+, (a1)+
+  subq.l   #1, d0
+1:move.l   d0, d1
+  lsr.l    #5, d0
+  beq      4f
+  subq.l   #1, d0
+2:movem.l  (a0)+, d2-d7/a2-a3
+  movem.l  d2-d7/a2-a3, (a1)
+  lea      32(a1), a1
+  dbf      d0, 2b
+  swap     d0
+  dbf      d0, 3f
+  bra      4f
+3:swap     d0
+  bra      2b
+  // tail: remaining longs, then word, then byte
+4:move.w   d1, d0
+  lsr.w    #2, d0
+  andi.w   #7, d0
+  bra      6f
+5:move.l   (a0)+, (a1)+
+6:dbf      d0, 5b
+  btst     #1, d1
+  beq      7f
+  move.w   (a0)+, (a1)+
+7:btst     #0, d1
+  beq      8f
+  move.b   (a0)+, (a1)+
+8:POPM     d2-d7/a2-a3
+  rts
+
+memcpy_block_bytes:
+  subq.l   #1, d0
+  bcs      2f
+0:move.b   (a0)+, (a1)+
+  dbf      d0, 0b
+  swap     d0
+  dbf      d0, 1f
+  rts
+1:swap     d0
+  bra      0b
+2:rts
@@ -0,0 +1,86 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file rpc.def.h
+ * @brief Definitions shared by the Main and Sub sides of the comm register RPC
+ *
+ * @details
+ * Requests and responses are passed through the Gate Array comm registers:
+ *
+ * Register | Written by | Contents
+ * ---------|------------|---------
+ * COMCMD0  | Main       | Sequence number (upper byte), command (lower byte)
+ * COMCMD1-7| Main       | Request parameters
+ * COMSTAT0 | Sub        | Sequence number (upper byte), status (lower byte)
+ * COMSTAT1-7| Sub       | Response values
+ *
+ * The sequence number is never 0, and changes with every request, so the Sub
+ * side can tell a new request from one it has already handled without Main
+ * needing to clear COMCMD0 in between. The request is complete when COMSTAT0
+ * holds the same sequence number and a status other than RPC_STATUS_PENDING.
+ *
+ * When built with RPC_LATENCY defined (see the RPC_LATENCY make setting), both
+ * sides keep a table of latencies per command ID. The Main CPU measures the
+ * round trip, from the request being sent to the response being seen, in
+ * scanlines. The Sub CPU measures the time spent servicing the request, from
+ * it being picked up to it being completed, in stopwatch ticks (30.72us).
+ * The difference between the two is the time the request sat waiting for the
+ * Sub CPU to notice it.
+ */
+
+#ifndef MEGADEV__RPC_DEF_H
+#define MEGADEV__RPC_DEF_H
+
+/**
+ * @def RPC_PARAM_COUNT
+ * @brief Number of parameter (and response) words per request
+ */
+#define RPC_PARAM_COUNT 7
+
+/**
+ * @def RPC_STATUS_OK
+ * @brief Request completed successfully
+ * @details Handlers may return any value from 0 up to RPC_STATUS_USER_MAX as
+ * their status; 0 is conventionally success.
+ */
+#define RPC_STATUS_OK 0
+
+#define RPC_STATUS_USER_MAX 0xFC
+
+/**
+ * @def RPC_STATUS_IDLE
+ * @brief No request is outstanding
+ */
+#define RPC_STATUS_IDLE 0xFD
+
+/**
+ * @def RPC_STATUS_UNKNOWN
+ * @brief The Sub CPU has no handler for the command
+ */
+#define RPC_STATUS_UNKNOWN 0xFE
+
+/**
+ * @def RPC_STATUS_PENDING
+ * @brief The request has not yet been completed
+ */
+#define RPC_STATUS_PENDING 0xFF
+
+/**
+ * @def RPC_LATENCY_COMMANDS
+ * @brief Number of command IDs tracked in the latency tables
+ * @details Commands with higher IDs are not measured.
+ */
+#ifndef RPC_LATENCY_COMMANDS
+#define RPC_LATENCY_COMMANDS 32
+#endif
+
+/*
+ * RpcLatency layout
+ */
+#define RPC_LATENCY_COUNT 0
+#define RPC_LATENCY_MIN   2
+#define RPC_LATENCY_MAX   4
+#define RPC_LATENCY_TOTAL 6
+#define RPC_LATENCY_SIZE  10
+
+#endif
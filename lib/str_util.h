@@ -2,7 +2,7 @@
  * [ M E G A D E V ]   a Sega Mega CD devkit
  *
  * @file str_util.h
- * @brief C wrappers for hex string conversion functions
+ * @brief C wrappers for hex and decimal string conversion functions
  */
 
 #ifndef MEGADEV__MAIN_STR_UTIL_H
@@ -67,6 +67,31 @@ static inline void hextoa32(register u32 value, register char * const string)
   }
 }
 
+/**
+ * @fn Convert a 16 bit value to a 5 digit decimal ASCII string
+ */
+static inline void dectoa16(register u16 value, register char * const string)
+{
+  register char * output = string + 5;
+  register u32 work = value;
+  u16 digit;
+  for (u8 i = 0; i < 5; ++i)
+  {
+    // quotient in the low word, remainder in the high word
+    asm("\
+  divu.w #10, %[work] \n\
+  swap %[work] \n\
+  move.w %[work], %[digit] \n\
+  clr.w %[work] \n\
+  swap %[work] \n\
+		"
+        : [work] "+d"(work), [digit] "=d"(digit)
+        :
+        : "cc");
+    *--output = '0' + digit;
+  }
+}
+
 static inline bool
 strcmp(register char const * str1, register char const * str2)
 {
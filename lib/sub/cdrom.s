@@ -488,6 +488,18 @@ accloop_reentry:
   POP      acc_loop_jump
   rts
 
+/**
+ * @fn cdrom_task
+ * @brief Resume the access loop as a task for the Sub CPU scheduler
+ * @details Spawn this with sched_spawn instead of using PROCESS_ACC_LOOP in
+ * INT2. The loop still breaks with accloop_reentry, which returns to the
+ * scheduler without a yield, so the task resumes here each time.
+ */
+.global cdrom_task
+cdrom_task:
+  movea.l  acc_loop_jump, a0
+  jmp      (a0)
+
 .section .bss
 
 /**
@@ -0,0 +1,101 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file sub/cmdq.h
+ * @brief Batched command queue from the Main CPU (Sub CPU side)
+ *
+ * @details
+ * Receives batches of commands sent with main/cmdq.h. When the doorbell is
+ * rung, take ownership of Word RAM and pass the buffer to
+ * @ref cmdq_drain_c, which runs each command through the dispatch table and
+ * acknowledges the batch. For example, in the Sub CPU main loop:
+ *
+ *   if (cmdq_pending() && wram_try_acquire_c())
+ *   {
+ *     cmdq_drain_c(queue_buffer, handlers, HANDLER_COUNT);
+ *     wram_release_c();
+ *   }
+ *
+ * Be sure to include cmdq_sub.s in your module when using these.
+ */
+
+#ifndef MEGADEV__SUB_CMDQ_H
+#define MEGADEV__SUB_CMDQ_H
+
+#include "cmdq.def.h"
+#include "sub/gate_arr.h"
+#include "types.h"
+
+/**
+ * @typedef CmdqHandler
+ * @brief Command handler
+ * @param params Pointer to the command parameters (in Word RAM)
+ * @param count Number of parameter words
+ */
+typedef void (*CmdqHandler)(u16 const * params, u16 count);
+
+/**
+ * @struct CmdqStats
+ * @brief Command queue statistics
+ */
+typedef struct CmdqStats
+{
+  /**
+   * @brief Number of batches drained
+   */
+  u16 batches;
+  /**
+   * @brief Largest number of commands in a single batch
+   */
+  u16 max_batch;
+  /**
+   * @brief Total number of commands drained
+   */
+  u32 commands;
+} CmdqStats;
+
+/**
+ * @var cmdq_stats
+ * @brief Command queue statistics
+ * @note May be cleared at any time to restart the measurements
+ */
+extern volatile CmdqStats cmdq_stats;
+
+/**
+ * @fn cmdq_pending
+ * @brief Check if the Main CPU has rung the doorbell for a new batch
+ */
+static inline bool cmdq_pending()
+{
+  return ((*ga_reg_comflags_main ^ *ga_reg_comflags_sub) & CMDQ_FLAG_MASK) !=
+         0;
+}
+
+/**
+ * @fn cmdq_drain_c
+ * @brief Run every command in a batch, then acknowledge it
+ * @param buffer Pointer to the queue buffer in Word RAM
+ * @param table Array of handlers, indexed by command ID
+ * @param count Number of entries in the table
+ * @return Number of commands in the batch
+ * @note Word RAM must be owned by the Sub CPU
+ */
+static inline u16
+cmdq_drain_c(void const * buffer, CmdqHandler const * table, u16 count)
+{
+  register u32 a0_buffer asm("a0") = (u32) buffer;
+  register u32 a1_table asm("a1") = (u32) table;
+  register u16 d0_count asm("d0") = count;
+
+  asm volatile(
+    "\
+  jsr cmdq_drain \n\
+		"
+    : "+d"(d0_count), "+a"(a0_buffer), "+a"(a1_table)
+    :
+    : "d1", "cc", "memory");
+
+  return d0_count;
+}
+
+#endif
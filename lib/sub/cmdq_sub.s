@@ -0,0 +1,85 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file sub/cmdq_sub.s
+ * @brief Batched command queue from the Main CPU (Sub CPU side)
+ *
+ * @details
+ * See cmdq.def.h for the buffer layout and sub/cmdq.h for usage.
+ */
+
+#ifndef MEGADEV__SUB_CMDQ_S
+#define MEGADEV__SUB_CMDQ_S
+
+#include <macros.s>
+#include <cmdq.def.h>
+#include <sub/gate_arr.def.h>
+
+.section .text
+
+/**
+ * @fn cmdq_drain
+ * @brief Run every command in a batch, then acknowledge it
+ * @param[in] A0.l Pointer to the queue buffer
+ * @param[in] A1.l Pointer to the dispatch table (array of handler pointers)
+ * @param[in] D0.w Number of entries in the table
+ * @param[out] D0.w Number of commands in the batch
+ * @clobber d1/a0-a1
+ * @details Handlers are called as C functions:
+ *   void handler(u16 const * params, u16 count)
+ * Commands without a handler are skipped.
+ * @note Word RAM must be owned by the Sub CPU
+ */
+SUB cmdq_drain
+  PUSHM    d2-d5/a2-a4
+  movea.l  a1, a3        // dispatch table
+  move.w   d0, d3        // table size
+  move.w   (a0)+, d5     // commands in this batch
+  movea.l  a0, a2        // read pointer
+  move.w   d5, d4
+  bra      5f
+
+0:move.w   (a2)+, d0
+  moveq    #0, d1
+  move.b   d0, d1        // parameter count
+  lsr.w    #8, d0        // command
+  movea.l  a2, a4        // parameters
+  move.w   d1, d2
+  add.w    d2, d2
+  adda.w   d2, a2        // skip to the next command
+  cmp.w    d3, d0
+  bcc      5f
+  lsl.w    #2, d0
+  move.l   (a3,d0.w), d0
+  beq      5f
+  movea.l  d0, a0
+  move.l   d1, -(sp)
+  move.l   a4, -(sp)
+  jsr      (a0)
+  addq.l   #8, sp
+5:dbf      d4, 0b
+
+  // statistics
+  addq.w   #1, cmdq_stats+CMDQ_STATS_BATCHES
+  moveq    #0, d0
+  move.w   d5, d0
+  add.l    d0, cmdq_stats+CMDQ_STATS_COMMANDS
+  cmp.w    cmdq_stats+CMDQ_STATS_MAX_BATCH, d0
+  bls      6f
+  move.w   d0, cmdq_stats+CMDQ_STATS_MAX_BATCH
+
+  // acknowledge by matching our doorbell bit to the Main CPU's
+6:btst     #CMDQ_FLAG_BIT, GA_REG_COMFLAGS
+  beq      7f
+  bset     #CMDQ_FLAG_BIT, GA_REG_COMFLAGS+1
+  bra      8f
+7:bclr     #CMDQ_FLAG_BIT, GA_REG_COMFLAGS+1
+8:POPM     d2-d5/a2-a4
+  rts
+
+.section .bss
+
+.global cmdq_stats
+cmdq_stats: .space CMDQ_STATS_SIZE
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file sub/commsync.h
+ * @brief Per-frame mirroring of the Gate Array comm registers (Sub CPU side)
+ *
+ * @details
+ * The Sub CPU counterpart of main/commsync.h. Here @ref comm_cmd is the
+ * snapshot of the COMCMD registers as last written by the Main CPU, and
+ * @ref comm_stat is sent to the COMSTAT registers.
+ *
+ * Nothing calls the sync automatically: the program must call comm_sync
+ * once per frame from sp_int2, alongside the CD-ROM access loop:
+ *
+ *   GLABEL sp_int2
+ *     PROCESS_ACC_LOOP
+ *     jsr comm_sync
+ *     rts
+ *
+ * and comm_sync_reset from sp_init. Use @ref comm_lock and @ref comm_unlock
+ * around code that must read or write several words of the mirrors together.
+ * As on the Main side, the sync writes all of the COMSTAT registers each time
+ * it sends, so it cannot be mixed with code which uses the live registers.
+ *
+ * See commsync.def.h for the flag semantics.
+ *
+ * Be sure to include commsync_sub.s in your module when using these.
+ */
+
+#ifndef MEGADEV__SUB_COMMSYNC_H
+#define MEGADEV__SUB_COMMSYNC_H
+
+#include "commsync.def.h"
+#include "types.h"
+
+/**
+ * @var comm_cmd
+ * @brief Snapshot of COMCMD0-7
+ */
+extern volatile u16 const comm_cmd[COMMSYNC_WORDS];
+
+/**
+ * @var comm_stat
+ * @brief Values to be sent to COMSTAT0-7
+ */
+extern volatile u16 comm_stat[COMMSYNC_WORDS];
+
+/**
+ * @var comm_sync_count
+ * @brief Incremented each time a new snapshot is received
+ */
+extern volatile u16 comm_sync_count;
+
+/**
+ * @var comm_hold
+ * @brief The mirrors are not synced while this is non-zero
+ */
+extern volatile u8 comm_hold;
+
+/**
+ * @fn comm_sync_reset_c
+ * @brief Clear the mirrors and the Sub side sync flags
+ * @note Both CPUs should reset before the sync is started
+ */
+static inline void comm_sync_reset_c()
+{
+  asm volatile(
+    "\
+  jsr comm_sync_reset \n\
+		"
+    :
+    :
+    : "d0", "a0", "cc", "memory");
+}
+
+/**
+ * @fn comm_sync_c
+ * @brief Exchange the mirrors with the comm registers
+ * @note Call this once per frame from sp_int2
+ */
+static inline void comm_sync_c()
+{
+  asm volatile(
+    "\
+  jsr comm_sync \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+/**
+ * @fn comm_lock
+ * @brief Prevent the mirrors from being synced
+ */
+static inline void comm_lock()
+{
+  ++comm_hold;
+}
+
+/**
+ * @fn comm_unlock
+ * @brief Allow the mirrors to be synced again
+ */
+static inline void comm_unlock()
+{
+  --comm_hold;
+}
+
+#endif
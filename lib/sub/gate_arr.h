@@ -568,6 +568,8 @@ typedef u16 volatile * ga_reg;
 /**
  * @fn wait_2m
  * @brief Wait for Sub CPU access to 2M Word RAM
+ * @sa wram_acquire_c for a version with a timeout, and sub/wordram.h for
+ * non-blocking ownership handling
  */
 static inline void wait_2m()
 {
@@ -583,6 +585,7 @@ static inline void wait_2m()
 /**
  * @fn grant_2m
  * @brief Grant 2M Word RAM access to the Main CPU and wait for confirmation
+ * @sa wram_release_c
  */
 static inline void grant_2m()
 {
@@ -628,6 +631,31 @@ static inline void set_2m()
     : "i"(BIT_GA_REG_MODE), "i"(GA_REG_MEMMODE + 1));
 }
 
+/**
+ * @fn swap_1m
+ * @brief Swap the Word RAM banks between the CPUs (1M mode only)
+ * @details The Main CPU continues to see its bank at the same address, as
+ * does the Sub CPU, so this exchanges the contents of the two banks from the
+ * point of view of both CPUs.
+ */
+static inline void swap_1m()
+{
+  asm volatile(
+    "\
+			bchg %0, %p1 \n\
+			beq 2f \n\
+		1:btst %0, %p1 \n\
+			bne 1b \n\
+			bra 3f \n\
+		2:btst %0, %p1 \n\
+			beq 2b \n\
+		3: \n\
+		"
+    :
+    : "i"(BIT_GA_REG_RET), "i"(GA_REG_MEMMODE + 1)
+    : "cc");
+}
+
 /**
  * @fn clear_comm_regs
  * Clears the comm status registers (COMSTAT) and flags (COMFLAGS)
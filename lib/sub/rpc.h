@@ -0,0 +1,140 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file sub/rpc.h
+ * @brief Dispatch of requests from the Main CPU over the comm registers
+ *
+ * @details
+ * Requests sent from main/rpc.h are routed through a dispatch table, indexed
+ * by command ID. Call @ref rpc_dispatch_c regularly from the Sub CPU main
+ * loop; it returns immediately if there is no new request.
+ *
+ * A handler receives pointers to the seven parameter words (COMCMD1-7) and
+ * the seven response words (COMSTAT1-7), and returns its status. Long-running
+ * work (such as a file load through the CD access loop) can return
+ * RPC_STATUS_PENDING and finish later with @ref rpc_complete_c, leaving the
+ * dispatcher free in the meantime.
+ *
+ * Call @ref rpc_init_c before the Main CPU sends its first request.
+ *
+ * Be sure to include rpc_sub.s in your module when using these.
+ */
+
+#ifndef MEGADEV__SUB_RPC_H
+#define MEGADEV__SUB_RPC_H
+
+#include "rpc.def.h"
+#include "types.h"
+
+/**
+ * @typedef RpcHandler
+ * @brief Request handler
+ * @param params Request parameters (COMCMD1-7)
+ * @param results Response values (COMSTAT1-7)
+ * @return Status for the Main CPU; RPC_STATUS_PENDING to complete it later
+ */
+typedef u8 (*RpcHandler)(u16 const volatile * params, u16 volatile * results);
+
+/**
+ * @fn rpc_init_c
+ * @brief Set the dispatch table and reset the Sub side of the RPC channel
+ * @param table Array of handlers, indexed by command ID; NULL entries are
+ * answered with RPC_STATUS_UNKNOWN
+ * @param count Number of entries in the table
+ */
+static inline void rpc_init_c(RpcHandler const * table, u16 count)
+{
+  register u32 a0_table asm("a0") = (u32) table;
+  register u16 d0_count asm("d0") = count;
+
+  asm volatile(
+    "\
+  jsr rpc_init \n\
+		"
+    : "+a"(a0_table), "+d"(d0_count)
+    :
+    : "cc", "memory");
+}
+
+/**
+ * @fn rpc_dispatch_c
+ * @brief Handle a new request from the Main CPU, if there is one
+ * @return true if a request was handled
+ */
+static inline bool rpc_dispatch_c()
+{
+  register u8 result;
+
+  asm volatile(
+    "\
+  jsr rpc_dispatch \n\
+  scc %0 \n\
+		"
+    : "=d"(result)
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+
+  return result;
+}
+
+/**
+ * @fn rpc_complete_c
+ * @brief Complete a request for which the handler returned RPC_STATUS_PENDING
+ * @param status Status for the Main CPU
+ * @note Write any results to COMSTAT1-7 before calling this
+ */
+static inline void rpc_complete_c(u8 status)
+{
+  register u8 d0_status asm("d0") = status;
+
+  asm volatile(
+    "\
+  jsr rpc_complete \n\
+		"
+    :
+    : "d"(d0_status)
+    : "d1", "cc", "memory");
+}
+
+#ifdef RPC_LATENCY
+
+/**
+ * @struct RpcLatency
+ * @brief Latency measurements for a single command ID
+ */
+typedef struct RpcLatency
+{
+  /**
+   * @brief Number of completed requests
+   * @details Measurement stops if this reaches 0xFFFF
+   */
+  u16 count;
+  /**
+   * @brief Shortest service time
+   */
+  u16 min;
+  /**
+   * @brief Longest service time
+   */
+  u16 max;
+  /**
+   * @brief Sum of all service times
+   */
+  u32 total;
+} RpcLatency;
+
+/**
+ * @var rpc_latency
+ * @brief Service times, indexed by command ID
+ * @details Times are in stopwatch ticks (30.72us), from the request being
+ * picked up by rpc_dispatch_c to it being completed. The stopwatch wraps after
+ * 4096 ticks (about 126ms), so longer requests are not measured correctly.
+ * The Main CPU cannot read Sub CPU memory directly, so to compare these with
+ * the round trip times, return entries through a handler of your own.
+ * @note Cleared by rpc_init_c
+ */
+extern volatile RpcLatency rpc_latency[RPC_LATENCY_COMMANDS];
+
+#endif
+
+#endif
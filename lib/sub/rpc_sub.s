@@ -0,0 +1,174 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file sub/rpc_sub.s
+ * @brief Dispatch of requests from the Main CPU over the comm registers
+ *
+ * @details
+ * See rpc.def.h for the protocol and sub/rpc.h for usage.
+ */
+
+#ifndef MEGADEV__SUB_RPC_S
+#define MEGADEV__SUB_RPC_S
+
+#include <macros.s>
+#include <rpc.def.h>
+#include <sub/gate_arr.def.h>
+
+.section .text
+
+/**
+ * @fn rpc_init
+ * @brief Set the dispatch table and reset the Sub side of the RPC channel
+ * @param[in] A0.l Pointer to the dispatch table (array of handler pointers)
+ * @param[in] D0.w Number of entries in the table
+ * @clobber d0/a0
+ */
+SUB rpc_init
+  move.l   a0, rpc_table
+  move.w   d0, rpc_table_count
+  sf       rpc_seq
+  clr.w    GA_REG_COMSTAT0
+#ifdef RPC_LATENCY
+  lea      rpc_latency, a0
+  move.w   #(RPC_LATENCY_COMMANDS * RPC_LATENCY_SIZE / 2) - 1, d0
+0:clr.w    (a0)+
+  dbf      d0, 0b
+#endif
+  rts
+
+/**
+ * @fn rpc_dispatch
+ * @brief Handle a new request from the Main CPU, if there is one
+ * @param[out] CC A request was handled
+ * @param[out] CS No new request
+ * @clobber d0-d1/a0-a1
+ * @details The handler is called as a C function:
+ *   u8 handler(u16 const volatile * params, u16 volatile * results)
+ * The parameters and results point directly at COMCMD1 and COMSTAT1, and
+ * the return value becomes the status. A handler may return
+ * RPC_STATUS_PENDING to finish the request later with rpc_complete.
+ */
+SUB rpc_dispatch
+  move.w   GA_REG_COMCMD0, d0
+  move.w   d0, d1
+  lsr.w    #8, d1
+  beq      9f           // sequence 0: nothing sent yet
+  cmp.b    rpc_seq, d1
+  beq      9f           // already handled (or in progress)
+  move.b   d1, rpc_seq
+
+  // acknowledge the request
+  lsl.w    #8, d1
+  move.b   #RPC_STATUS_PENDING, d1
+  move.w   d1, GA_REG_COMSTAT0
+
+  andi.w   #0xFF, d0
+#ifdef RPC_LATENCY
+  move.w   GA_REG_STOPWATCH, rpc_lat_start
+  move.b   d0, rpc_lat_cmd
+#endif
+  cmp.w    rpc_table_count, d0
+  bcc      2f
+  lsl.w    #2, d0
+  movea.l  rpc_table, a0
+  move.l   (a0,d0.w), d0
+  beq      2f
+  movea.l  d0, a0
+  pea      GA_REG_COMSTAT1
+  pea      GA_REG_COMCMD1
+  jsr      (a0)
+  addq.l   #8, sp
+  cmpi.b   #RPC_STATUS_PENDING, d0
+  beq      1f
+  bsr      rpc_complete
+1:move     #0, ccr
+  rts
+
+2:move.b   #RPC_STATUS_UNKNOWN, d0
+  bsr      rpc_complete
+  move     #0, ccr
+  rts
+
+9:move     #1, ccr
+  rts
+
+/**
+ * @fn rpc_complete
+ * @brief Complete the current request
+ * @param[in] D0.b Status
+ * @clobber d1
+ * @note Any results must already be in COMSTAT1-7
+ */
+SUB rpc_complete
+  move.b   rpc_seq, d1
+  lsl.w    #8, d1
+  move.b   d0, d1
+  move.w   d1, GA_REG_COMSTAT0
+#ifdef RPC_LATENCY
+  PUSHM    d0/a0
+  move.w   GA_REG_STOPWATCH, d1
+  sub.w    rpc_lat_start, d1
+  andi.w   #0xFFF, d1
+  moveq    #0, d0
+  move.b   rpc_lat_cmd, d0
+  lea      rpc_latency, a0
+  bsr      rpc_latency_add
+  POPM     d0/a0
+#endif
+  rts
+
+#ifdef RPC_LATENCY
+/**
+ * @fn rpc_latency_add
+ * @brief Add a sample to the latency table
+ * @param[in] A0.l Pointer to the latency table
+ * @param[in] D0.w Command ID
+ * @param[in] D1.w Latency
+ * @clobber d0/a0
+ */
+rpc_latency_add:
+  cmpi.w   #RPC_LATENCY_COMMANDS, d0
+  bcc      9f
+  mulu.w   #RPC_LATENCY_SIZE, d0
+  adda.w   d0, a0
+  cmpi.w   #0xFFFF, RPC_LATENCY_COUNT(a0)
+  beq      9f           // full; stop so that the average stays valid
+  tst.w    RPC_LATENCY_COUNT(a0)
+  beq      1f
+  cmp.w    RPC_LATENCY_MIN(a0), d1
+  bcc      2f
+1:move.w   d1, RPC_LATENCY_MIN(a0)
+2:cmp.w    RPC_LATENCY_MAX(a0), d1
+  bls      3f
+  move.w   d1, RPC_LATENCY_MAX(a0)
+3:addq.w   #1, RPC_LATENCY_COUNT(a0)
+  moveq    #0, d0
+  move.w   d1, d0
+  add.l    d0, RPC_LATENCY_TOTAL(a0)
+9:rts
+#endif
+
+.section .bss
+
+rpc_table: .long 0
+
+rpc_table_count: .word 0
+
+.global rpc_seq
+rpc_seq: .byte 0
+
+.align 2
+
+#ifdef RPC_LATENCY
+.global rpc_latency
+rpc_latency: .space RPC_LATENCY_COMMANDS * RPC_LATENCY_SIZE
+
+rpc_lat_start: .word 0
+
+rpc_lat_cmd: .byte 0
+
+.align 2
+#endif
+
+#endif
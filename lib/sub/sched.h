@@ -0,0 +1,117 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file sub/sched.h
+ * @brief Cooperative multitasking for the Sub CPU
+ *
+ * @details
+ * Runs several tasks from INT2 (or the INT3 timer), each getting a slice of
+ * time per interrupt. See sched_sub.s for the details.
+ *
+ * Tasks which yield part way through must be written in asm, as a yield
+ * cannot keep a C stack frame. A C function can still be a task, in which
+ * case it is called from the start on every run and should keep its progress
+ * in global variables. For example, in the SP:
+ *
+ *   // in sp_init
+ *   sched_init_c();
+ *   sched_spawn_c(cdrom_task);
+ *   sched_spawn_c(pcm_refill);
+ *
+ *   // in sp_int2
+ *   sched_run_c();
+ *
+ * Be sure to include sched_sub.s in your module when using these.
+ */
+
+#ifndef MEGADEV__SUB_SCHED_H
+#define MEGADEV__SUB_SCHED_H
+
+#include "types.h"
+
+/**
+ * @var sched_current
+ * @brief Slot of the task being run
+ */
+extern u16 volatile sched_current;
+
+/**
+ * @fn cdrom_task
+ * @brief The CD-ROM access loop as a task (in cdrom.s)
+ */
+extern void cdrom_task();
+
+/**
+ * @fn sched_init_c
+ * @brief Remove all tasks
+ */
+static inline void sched_init_c()
+{
+  asm volatile(
+    "\
+  jsr sched_init \n\
+		"
+    :
+    :
+    : "d0", "a0", "cc", "memory");
+}
+
+/**
+ * @fn sched_spawn_c
+ * @brief Add a task
+ * @param entry Task entry
+ * @return Slot of the task, or -1 if there are no free slots
+ */
+static inline s16 sched_spawn_c(void (*entry)())
+{
+  register u32 a0_entry asm("a0") = (u32) entry;
+  register s16 d0_slot asm("d0");
+
+  asm volatile(
+    "\
+  jsr sched_spawn \n\
+  bcc 1f \n\
+  moveq #-1, d0 \n\
+1: \n\
+		"
+    : "=d"(d0_slot), "+a"(a0_entry)
+    :
+    : "a1", "cc", "memory");
+
+  return d0_slot;
+}
+
+/**
+ * @fn sched_kill_c
+ * @brief Remove a task
+ * @param slot Slot of the task
+ */
+static inline void sched_kill_c(u16 slot)
+{
+  register u16 d0_slot asm("d0") = slot;
+
+  asm volatile(
+    "\
+  jsr sched_kill \n\
+		"
+    : "+d"(d0_slot)
+    :
+    : "a0", "cc", "memory");
+}
+
+/**
+ * @fn sched_run_c
+ * @brief Resume every task once
+ */
+static inline void sched_run_c()
+{
+  asm volatile(
+    "\
+  jsr sched_run \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+#endif
@@ -0,0 +1,159 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file sub/sched_sub.s
+ * @brief Cooperative multitasking for the Sub CPU
+ *
+ * @details
+ * A generalisation of the CD-ROM access loop (see accloop_reentry in
+ * cdrom.s). Each task is a continuation, the address from which it will
+ * resume. sched_run resumes every task in turn; a task runs until it yields,
+ * at which point its continuation is saved and sched_run moves on to the next
+ * one. Calling sched_run from INT2 (or the INT3 timer) then gives each task a
+ * slice of time per interrupt, so several long running jobs can make progress
+ * together instead of blocking each other.
+ *
+ * As with the access loop, a task runs on the stack of whoever called
+ * sched_run, so nothing can be left on the stack or in registers across a
+ * yield; keep any state in memory. To yield, call sched_yield (with bsr or
+ * jsr) with the stack as it was when the task was resumed. A task which
+ * returns with rts instead is resumed from its last continuation, so a plain
+ * subroutine (or C function) works as a task which is called on every run.
+ * A task ends itself by calling sched_exit.
+ *
+ * The access loop itself can be run as a task with cdrom_task (in cdrom.s).
+ */
+
+#ifndef MEGADEV__SUB_SCHED_S
+#define MEGADEV__SUB_SCHED_S
+
+#include <macros.s>
+
+/**
+ * @def SCHED_SLOTS
+ * @brief Maximum number of tasks
+ */
+#ifndef SCHED_SLOTS
+#define SCHED_SLOTS 8
+#endif
+
+.section .text
+
+/**
+ * @fn sched_init
+ * @brief Remove all tasks
+ * @clobber d0/a0
+ */
+SUB sched_init
+  lea      sched_slots, a0
+  moveq    #SCHED_SLOTS - 1, d0
+0:clr.l    (a0)+
+  dbf      d0, 0b
+  sf       sched_busy
+  rts
+
+/**
+ * @fn sched_spawn
+ * @brief Add a task
+ * @param[in] A0.l Pointer to the task entry
+ * @param[out] D0.w Task slot
+ * @param[out] CC Task added
+ * @param[out] CS No free slots
+ * @clobber a1
+ * @details The task first runs from its entry on the next sched_run.
+ */
+SUB sched_spawn
+  lea      sched_slots, a1
+  moveq    #0, d0
+0:tst.l    (a1)+
+  beq      1f
+  addq.w   #1, d0
+  cmpi.w   #SCHED_SLOTS, d0
+  bcs      0b
+  move     #1, ccr
+  rts
+1:move.l   a0, -(a1)
+  move     #0, ccr
+  rts
+
+/**
+ * @fn sched_kill
+ * @brief Remove a task
+ * @param[in] D0.w Task slot
+ * @clobber d0/a0
+ * @note A task should end itself with sched_exit rather than this
+ */
+SUB sched_kill
+  lea      sched_slots, a0
+  lsl.w    #2, d0
+  clr.l    (a0,d0.w)
+  rts
+
+/**
+ * @fn sched_run
+ * @brief Resume every task once
+ * @clobber d0-d1/a0-a1
+ * @details Meant to be called from INT2 or INT3. If it is interrupted and
+ * called again (e.g. from INT3 during INT2), the second call does nothing.
+ */
+SUB sched_run
+  tas      sched_busy
+  bne      9f
+  PUSHM    d2-d7/a2-a6
+  moveq    #0, d0
+0:move.w   d0, sched_current
+  lsl.w    #2, d0
+  lea      sched_slots, a0
+  move.l   (a0,d0.w), d0
+  beq      1f
+  movea.l  d0, a0
+  jsr      (a0)
+1:move.w   sched_current, d0
+  addq.w   #1, d0
+  cmpi.w   #SCHED_SLOTS, d0
+  bcs      0b
+  POPM     d2-d7/a2-a6
+  sf       sched_busy
+9:rts
+
+/**
+ * @fn sched_yield
+ * @brief Save the continuation of the running task and return to sched_run
+ * @details Call with bsr or jsr from a task; the task resumes from the
+ * following instruction on the next run. The stack must be as it was when
+ * the task was resumed.
+ */
+SUB sched_yield
+  move.w   sched_current, d0
+  lsl.w    #2, d0
+  lea      sched_slots, a0
+  move.l   (sp)+, (a0,d0.w)
+  rts
+
+/**
+ * @fn sched_exit
+ * @brief End the running task and return to sched_run
+ * @details Call with bsr or jsr from a task. The stack must be as it was
+ * when the task was resumed.
+ */
+SUB sched_exit
+  addq.l   #4, sp
+  move.w   sched_current, d0
+  lsl.w    #2, d0
+  lea      sched_slots, a0
+  clr.l    (a0,d0.w)
+  rts
+
+.section .bss
+
+.global sched_slots
+sched_slots: .space SCHED_SLOTS * 4
+
+.global sched_current
+sched_current: .word 0
+
+sched_busy: .byte 0
+
+.align 2
+
+#endif
@@ -0,0 +1,165 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file sub/wordram.h
+ * @brief 2M Word RAM ownership manager (Sub CPU side)
+ *
+ * @details
+ * This is a non-blocking alternative to @ref wait_2m / @ref grant_2m. Rather
+ * than spinning on the DMNA bit, the kernel can check ownership with
+ * @ref wram_try_acquire_c or register a callback with @ref wram_notify_c and
+ * carry on with other work (such as servicing the CD access loop) while the
+ * Main CPU finishes with Word RAM.
+ *
+ * @ref wram_update_c must be called once per frame from the INT2 handler
+ * (i.e. from sp_int2). Callbacks registered with @ref wram_notify_c are run
+ * from there, so they should be short and must not wait on Word RAM
+ * themselves.
+ *
+ * The time spent waiting is tracked in frames in @ref wram_stats. Waiting
+ * begins when an acquire attempt fails or a callback is registered, and ends
+ * when Word RAM is given over, so time during which nobody wanted Word RAM is
+ * not counted.
+ *
+ * Be sure to include wordram_sub.s in your module when using these.
+ */
+
+#ifndef MEGADEV__SUB_WORDRAM_H
+#define MEGADEV__SUB_WORDRAM_H
+
+#include "types.h"
+#include "wordram.def.h"
+
+/**
+ * @struct WordRamStats
+ * @brief Word RAM wait statistics
+ */
+typedef struct WordRamStats
+{
+  /**
+   * @brief Number of times Word RAM has been acquired
+   */
+  u16 acquired;
+  /**
+   * @brief Frames spent in the current wait
+   */
+  u16 wait_current;
+  /**
+   * @brief Longest single wait, in frames
+   */
+  u16 wait_max;
+  /**
+   * @brief Total frames spent waiting
+   */
+  u32 wait_total;
+} WordRamStats;
+
+/**
+ * @var wram_stats
+ * @brief Word RAM wait statistics
+ * @note May be cleared at any time to restart the measurements
+ */
+extern volatile WordRamStats wram_stats;
+
+/**
+ * @var wram_owner
+ * @brief Last known owner of 2M Word RAM
+ * @details One of WRAM_OWNER_UNKNOWN, WRAM_OWNER_SELF or WRAM_OWNER_OTHER
+ */
+extern volatile u8 wram_owner;
+
+/**
+ * @fn wram_try_acquire_c
+ * @brief Check if 2M Word RAM has been given to the Sub CPU, without waiting
+ * @return true if the Sub CPU owns Word RAM
+ */
+static inline bool wram_try_acquire_c()
+{
+  register u8 result;
+
+  asm volatile(
+    "\
+  jsr wram_try_acquire \n\
+  scc %0 \n\
+		"
+    : "=d"(result)
+    :
+    : "d0", "cc");
+
+  return result;
+}
+
+/**
+ * @fn wram_acquire_c
+ * @brief Wait for 2M Word RAM to be given to the Sub CPU
+ * @param timeout Maximum wait in frames; 0 to wait indefinitely
+ * @return true if the Sub CPU owns Word RAM, false on timeout
+ */
+static inline bool wram_acquire_c(u16 timeout)
+{
+  register u16 d0_timeout asm("d0") = timeout;
+  register u8 result;
+
+  asm volatile(
+    "\
+  jsr wram_acquire \n\
+  scc %1 \n\
+		"
+    : "+d"(d0_timeout), "=d"(result)
+    :
+    : "d1", "d2", "cc");
+
+  return result;
+}
+
+/**
+ * @fn wram_release_c
+ * @brief Give 2M Word RAM to the Main CPU without waiting for it to be taken
+ */
+static inline void wram_release_c()
+{
+  asm volatile(
+    "\
+  jsr wram_release \n\
+		"
+    :
+    :
+    : "cc", "memory");
+}
+
+/**
+ * @fn wram_notify_c
+ * @brief Register a function to be called from INT2 once the Sub CPU owns
+ * Word RAM
+ * @param callback Function to call once; NULL to cancel
+ */
+static inline void wram_notify_c(void (*callback)())
+{
+  register u32 a0_callback asm("a0") = (u32) callback;
+
+  asm volatile(
+    "\
+  jsr wram_notify \n\
+		"
+    :
+    : "a"(a0_callback)
+    : "cc", "memory");
+}
+
+/**
+ * @fn wram_update_c
+ * @brief Per-frame processing for the ownership manager
+ * @note Call this once per frame from the INT2 handler
+ */
+static inline void wram_update_c()
+{
+  asm volatile(
+    "\
+  jsr wram_update \n\
+		"
+    :
+    :
+    : "d0", "d1", "a0", "a1", "cc", "memory");
+}
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file sub/wordram_sub.s
+ * @brief 2M Word RAM ownership manager (Sub CPU side)
+ *
+ * @details
+ * See sub/wordram.h for usage. wram_update must be called once per frame
+ * from the INT2 handler for notify callbacks, timeouts and wait statistics
+ * to work.
+ */
+
+#ifndef MEGADEV__SUB_WORDRAM_S
+#define MEGADEV__SUB_WORDRAM_S
+
+#include <macros.s>
+#include <wordram.def.h>
+#include <sub/gate_arr.def.h>
+
+.section .text
+
+/**
+ * @fn wram_try_acquire
+ * @brief Check if 2M Word RAM has been given to the Sub CPU, without waiting
+ * @param[out] CC Sub CPU owns Word RAM
+ * @param[out] CS Word RAM is still held by the Main CPU
+ * @clobber d0
+ */
+SUB wram_try_acquire
+  btst     #BIT_GA_REG_DMNA, GA_REG_MEMMODE+1
+  bne      wram_owned
+  st       wram_waiting
+  move     #1, ccr
+  rts
+
+/**
+ * @fn wram_acquire
+ * @brief Wait for 2M Word RAM to be given to the Sub CPU
+ * @param[in] D0.w Timeout (in frames); 0 to wait indefinitely
+ * @param[out] CC Sub CPU owns Word RAM
+ * @param[out] CS Timed out
+ * @clobber d0-d2
+ * @note The timeout is counted by wram_update, so it will not expire if
+ * that is not being called from INT2
+ */
+SUB wram_acquire
+  move.w   d0, d1
+  move.w   wram_ticks, d2
+0:bsr      wram_try_acquire
+  bcc      1f
+  tst.w    d1
+  beq      0b
+  move.w   wram_ticks, d0
+  sub.w    d2, d0
+  cmp.w    d1, d0
+  bcs      0b
+  // Word RAM may have been handed over since the last check
+  bra      wram_try_acquire
+1:rts
+
+/**
+ * @fn wram_release
+ * @brief Give 2M Word RAM to the Main CPU
+ * @details This only waits for the RET request to latch, not for the Main CPU
+ * to do anything with it.
+ * @warning Word RAM must not be accessed by the Sub CPU after this call until
+ * it has been acquired again
+ */
+SUB wram_release
+  move.b   #WRAM_OWNER_OTHER, wram_owner
+0:bset     #BIT_GA_REG_RET, GA_REG_MEMMODE+1
+  btst     #BIT_GA_REG_RET, GA_REG_MEMMODE+1
+  beq      0b
+  rts
+
+/**
+ * @fn wram_notify
+ * @brief Register a routine to be called from INT2 once the Sub CPU owns
+ * Word RAM
+ * @param[in] A0.l Pointer to callback (0 to cancel)
+ * @details The callback is called only once. If Word RAM is already owned, it
+ * will be called on the next INT2.
+ */
+SUB wram_notify
+  move.l   a0, wram_callback
+  beq      1f
+  st       wram_waiting
+1:rts
+
+/**
+ * @fn wram_update
+ * @brief Per-frame processing for the ownership manager
+ * @clobber d0-d1/a0-a1, plus anything clobbered by the callback
+ * @note Call this once per frame from the INT2 handler (i.e. sp_int2)
+ */
+SUB wram_update
+  addq.w   #1, wram_ticks
+  btst     #BIT_GA_REG_DMNA, GA_REG_MEMMODE+1
+  beq      2f
+  bsr      wram_owned
+  move.l   wram_callback, d0
+  beq      9f
+  clr.l    wram_callback
+  movea.l  d0, a0
+  jmp      (a0)
+
+2:tst.b    wram_waiting
+  beq      9f
+  addq.w   #1, wram_stats+WRAM_STATS_WAIT_CURRENT
+  addq.l   #1, wram_stats+WRAM_STATS_WAIT_TOTAL
+9:rts
+
+/*
+  Marks Word RAM as owned and closes out the wait statistics if this is a
+  new acquisition
+  OUT: CC
+  BREAK: d0
+*/
+wram_owned:
+  sf       wram_waiting
+  cmpi.b   #WRAM_OWNER_SELF, wram_owner
+  beq      1f
+  move.b   #WRAM_OWNER_SELF, wram_owner
+  addq.w   #1, wram_stats+WRAM_STATS_ACQUIRED
+  move.w   wram_stats+WRAM_STATS_WAIT_CURRENT, d0
+  cmp.w    wram_stats+WRAM_STATS_WAIT_MAX, d0
+  bls      0f
+  move.w   d0, wram_stats+WRAM_STATS_WAIT_MAX
+0:clr.w    wram_stats+WRAM_STATS_WAIT_CURRENT
+1:move     #0, ccr
+  rts
+
+.section .bss
+
+.global wram_stats
+wram_stats: .space WRAM_STATS_SIZE
+
+.global wram_callback
+wram_callback: .long 0
+
+// frames counted by wram_update, for wram_acquire timeouts; unlike the
+// wait statistics, this is never reset
+wram_ticks: .word 0
+
+.global wram_owner
+wram_owner: .byte 0
+
+wram_waiting: .byte 0
+
+.align 2
+
+#endif
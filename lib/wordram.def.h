@@ -0,0 +1,38 @@
+/**
+ * [ M E G A D E V ]   a Sega Mega CD devkit
+ *
+ * @file wordram.def.h
+ * @brief Definitions shared by the Main and Sub Word RAM ownership managers
+ */
+
+#ifndef MEGADEV__WORDRAM_DEF_H
+#define MEGADEV__WORDRAM_DEF_H
+
+/**
+ * @def WRAM_OWNER_UNKNOWN
+ * @brief Ownership has not yet been checked
+ */
+#define WRAM_OWNER_UNKNOWN 0
+
+/**
+ * @def WRAM_OWNER_SELF
+ * @brief The calling CPU owns 2M Word RAM
+ */
+#define WRAM_OWNER_SELF 1
+
+/**
+ * @def WRAM_OWNER_OTHER
+ * @brief 2M Word RAM has been given (or is being given) to the other CPU
+ */
+#define WRAM_OWNER_OTHER 2
+
+/*
+ * WordRamStats layout
+ */
+#define WRAM_STATS_ACQUIRED     0
+#define WRAM_STATS_WAIT_CURRENT 2
+#define WRAM_STATS_WAIT_MAX     4
+#define WRAM_STATS_WAIT_TOTAL   6
+#define WRAM_STATS_SIZE         10
+
+#endif
@@ -6,13 +6,15 @@
 #include <main/vdp.h>
 #include <system.h>
 
-extern u8      next_module;
 extern u8      res_rain_chr;
 extern u16     res_rain_chr_sz;
 extern Palette res_rain_pal;
 
 void main()
 {
+  // let the Sub CPU start loading the next module while this one runs
+  preload_module(FILE_EX2_MMD);
+
   disable_interrupts();
   bios_load_pal_update(&res_rain_pal);
   bios_dma_xfer_word_ram(
@@ -36,6 +38,7 @@ void main()
     process_particles();
   } while (! (bios_joy1_hit & PAD_START));
 
-  next_module = FILE_EX2_MMD;
+  // set_next_module is defined in the ipx
+  set_next_module(FILE_EX2_MMD);
   return;
 }
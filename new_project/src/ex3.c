@@ -7,13 +7,15 @@
 #include <system.h>
 #include <types.h>
 
-extern u8      next_module;
 extern u8      res_bubbles_chr;
 extern u16     res_bubbles_chr_sz;
 extern Palette res_bubbles_pal;
 
 void main()
 {
+  // let the Sub CPU start loading the next module while this one runs
+  preload_module(FILE_EX1_MMD);
+
   disable_interrupts();
   bios_load_pal_update(&res_bubbles_pal);
   bios_dma_xfer_word_ram(
@@ -35,6 +37,7 @@ void main()
     process_particles();
   } while (! (bios_joy1_hit & PAD_START));
 
-  next_module = FILE_EX1_MMD;
+  // set_next_module is defined in the ipx
+  set_next_module(FILE_EX1_MMD);
   return;
 }
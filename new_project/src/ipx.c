@@ -10,6 +10,11 @@
 
 u8 next_module;
 
+#if PRELOAD_MODULES
+// The module waiting in the Sub CPU Word RAM bank
+u8 preloaded = NO_MODULE;
+#endif
+
 Particle particles[16];
 
 InitSettings settings;
@@ -111,6 +116,60 @@ void process_particles()
   }
 }
 
+void send_command(u16 command, u16 param)
+{
+  // In this example, we have the command for the Sub CPU stored in COMCMD0
+  // and the command argument in COMCMD1.
+  // Set the argument first
+  *ga_reg_comcmd1 = param;
+
+  // then set the command
+  *ga_reg_comcmd0 = command;
+
+  // wait for acknowledgment from the Sub CPU that the command was
+  // received and will be acted on
+  do
+  {
+    // the NOP is so GCC doesn't optimize the loop away
+    // though since comstat is marked volatile it should be fine...
+    asm("nop");
+  } while (*ga_reg_comstat0 == 0);
+
+  // reset the command to none (0) once we have the acknowledgment
+  *ga_reg_comcmd0 = 0;
+
+  // the Sub CPU side work will be complete when COMSTAT0 returns to 0
+  do
+  {
+    asm("nop");
+  } while (*ga_reg_comstat0 != 0);
+}
+
+// Modules call this as soon as they know which module comes next, so that
+// the Sub CPU can load it while they are running. It does nothing when
+// preloading is disabled.
+void preload_module(u8 module)
+{
+#if PRELOAD_MODULES
+  if (preloaded == module)
+    return;
+
+  // the Sub CPU acknowledges this right away and loads the module afterward
+  send_command(CMD_PRELOAD_FILE, module);
+  preloaded = module;
+#else
+  (void) module;
+#endif
+}
+
+// Modules call this before returning to choose the module that is run next.
+// They are linked only against the kernel service table, so they cannot
+// reach next_module directly.
+void set_next_module(u8 module)
+{
+  next_module = module;
+}
+
 void vblank_user()
 {
   bios_copy_sprlist();
@@ -145,39 +204,45 @@ void main()
   bios_palette[1] = 0xEEE;
   bios_vdp_update_flags |= BIOS_MASK_COPY_PALETTE;
 
+#if PRELOAD_MODULES
+  // The Sub CPU switches Word RAM to 1M mode when the first preload is
+  // requested, and it must own Word RAM to do so
+  grant_2m();
+
   do
   {
-    // make sure that the Sub CPU controls 2M Word RAM before we request the
-    // file
-    grant_2m();
-
-    // In this example, we have the command for the Sub CPU stored in COMCMD0
-    // and the command argument in COMCMD1. Command 1 will be "load a file"
-    // and the argument will be the ID for that file, which is defined in
-    // the SPX
-    // Set the argument first
-    *ga_reg_comcmd1 = next_module;
-
-    // then set the command
-    *ga_reg_comcmd0 = CMD_LOAD_FILE;
+    // The module that just finished will usually have asked for the next one
+    // to be preloaded already. If not (as with the first module, or if it
+    // changed its mind), request it now
+    preload_module(next_module);
 
-    // wait for acknowledgment from the Sub CPU that the command was
-    // received and will be acted on
+    // wait for the Sub CPU to finish loading it into its bank...
     do
     {
-      // the NOP is so GCC doesn't optimize the loop away
-      // though since comstat is marked volatile it should be fine...
       asm("nop");
-    } while (*ga_reg_comstat0 == 0);
+    } while (*ga_reg_comstat1 != next_module + 1);
 
-    // reset the command to none (0) once we have the acknowledgment
-    *ga_reg_comcmd0 = 0;
+    // ...and swap it with our bank, which holds the module that just ended
+    send_command(CMD_SWAP_BANKS, 0);
+    preloaded = NO_MODULE;
 
-    // the Sub CPU side work will be complete when COMSTAT0 returns to 0
-    do
-    {
-      asm("nop");
-    } while (*ga_reg_comstat0 != 0);
+    void (*mmd_main)() = init_mmd_1m();
+    asm("call_mmd:");
+    mmd_main();
+
+    bios_clear_tables();
+
+  } while (1);
+#else
+  do
+  {
+    // make sure that the Sub CPU controls 2M Word RAM before we request the
+    // file
+    grant_2m();
+
+    // Command 1 will be "load a file" and the argument will be the ID for
+    // that file, which is defined in the SPX
+    send_command(CMD_LOAD_FILE, next_module);
 
     wait_2m();
 
@@ -193,4 +258,5 @@ void main()
     bios_clear_tables();
 
   } while (1);
+#endif
 }
@@ -35,4 +35,8 @@ void init_particles(u16 main_tile, u16 end_tile, u8 main_width, u8 main_height,
 
 void process_particles();
 
+void preload_module(u8 module);
+
+void set_next_module(u8 module);
+
 #endif
\ No newline at end of file
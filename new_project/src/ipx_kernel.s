@@ -0,0 +1,10 @@
+#include <kernel.macros.s>
+
+// Services the IPX provides to the other modules. Entries must only ever be
+// added to the end; see kernel.macros.s for the versioning rules.
+KERNEL_TABLE_BEGIN 0x0100
+KERNEL_EXPORT init_particles
+KERNEL_EXPORT process_particles
+KERNEL_EXPORT preload_module
+KERNEL_EXPORT set_next_module
+KERNEL_TABLE_END
@@ -16,3 +16,8 @@ GLOBAL MODULE_RAM_LENGTH, 0x200
 // Finally, we must specify from where the code will actually execute, which is
 // to say, to where it should be copied after being put in Word RAM by the Sub
 GLOBAL MMD_DEST WORK_RAM
+
+// The service table used by the other modules (see ipx_kernel.s) has a fixed
+// location, so that the IPX can change without breaking them. It goes after
+// the .init section, leaving it some room to grow.
+GLOBAL KERNEL_TABLE_ORIGIN WORK_RAM + 0x800
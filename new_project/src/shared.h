@@ -4,12 +4,20 @@
 #ifndef SHARED_H
 #define SHARED_H
 
+// Set to 1 to have the Sub CPU load the next module into the free 1M Word RAM
+// bank while the current module is running (see the Module Preloading section
+// of docs/modules.md)
+#define PRELOAD_MODULES 0
+
 #define CMD_LOAD_FILE 1
 #define CMD_PLAY_CDDA 2
+#define CMD_PRELOAD_FILE 3
+#define CMD_SWAP_BANKS 4
 
 #define FILE_IPX_MMD 0
 #define FILE_EX1_MMD 1
 #define FILE_EX2_MMD 2
 #define FILE_EX3_MMD 3
+#define NO_MODULE 0xFF
 
 #endif
@@ -1,10 +1,17 @@
 #include "macros.s"
+#include "main/memmap.def.h"
+#include "shared.h"
 
 GLOBAL MMD_DEST 0
 
 GLOBAL MODULE_ROM_ORIGIN 0x200100
 
+#if PRELOAD_MODULES
+// when preloading, a module must fit within a single 1M bank
+GLOBAL MODULE_ROM_LENGTH WORD_RAM_1M_BANK1 + WORD_RAM_1M_SIZE - MODULE_ROM_ORIGIN
+#else
 GLOBAL MODULE_ROM_LENGTH 0x240000 - MODULE_ROM_ORIGIN
+#endif
 
 GLOBAL MODULE_RAM_ORIGIN 0xFFC000
 
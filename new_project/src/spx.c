@@ -9,6 +9,22 @@ void load_ipx();
 
 extern void sp_fatal();
 
+// Let the Main CPU know the command has been handled and wait for it to
+// clear the command
+void acknowledge()
+{
+  register u16 command;
+
+  *ga_reg_comstat0 = *ga_reg_comcmd0;
+  do
+  {
+    asm("nop");
+    command = *ga_reg_comcmd0;
+  } while (command != 0);
+
+  *ga_reg_comstat0 = 0;
+}
+
 char const * const filenames[] = {
   "IPX.MMD;1", "EX1.MMD;1", "EX2.MMD;1", "EX3.MMD;1"};
 
@@ -31,6 +47,34 @@ void main()
 
     param1 = *ga_reg_comcmd1;
 
+#if PRELOAD_MODULES
+    if (command == CMD_PRELOAD_FILE)
+    {
+      // Acknowledge right away so that the Main CPU can carry on running the
+      // current module while we load the next one into our Word RAM bank
+      *ga_reg_comstat1 = 0;
+      acknowledge();
+
+      // the first preload switches Word RAM to 1M mode, which requires that
+      // we have control of it
+      if (! (*ga_reg_memmode & GA_MASK_WORDRAM_LAYOUT))
+      {
+        wait_2m();
+        set_1m();
+      }
+
+      load_file(CDROM_LOAD_CDC, filenames[param1], (u8 *) WORD_RAM_1M);
+      if (access_op_result != CDROM_RESULT_OK)
+      {
+        sp_fatal();
+      }
+
+      // the module is ready to be swapped in
+      *ga_reg_comstat1 = param1 + 1;
+      continue;
+    }
+#endif
+
     switch (command)
     {
 
@@ -43,24 +87,18 @@ void main()
           sp_fatal();
         }
         break;
+
+#if PRELOAD_MODULES
+      // exchange the preloaded module in our bank with the Main CPU bank
+      case CMD_SWAP_BANKS:
+        swap_1m();
+        break;
+#endif
     }
 
     // not reaching here?
     asm(".global test_label3\ntest_label3:");
-    *ga_reg_comstat0 = *ga_reg_comcmd0;
-    do
-    {
-      asm("nop");
-      command = *ga_reg_comcmd0;
-    } while (command != 0);
-
-    do
-    {
-      asm("nop");
-      command = *ga_reg_comcmd0;
-    } while (command != 0);
-
-    *ga_reg_comstat0 = 0;
+    acknowledge();
 
   } while (1);
 }
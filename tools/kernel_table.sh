@@ -0,0 +1,118 @@
+#!/bin/sh
+#
+# [ M E G A D E V ]   a Sega Mega CD devkit
+#
+# kernel_table.sh
+# Generate the link script fragment for modules using a kernel service table
+#
+# If the kernel ELF has a service table (see kernel.macros.s), a fragment is
+# written which defines each exported service as the address of its table
+# entry, along with kernel_table and kernel_table_version (see kernel.h).
+# Modules are linked with this fragment instead of all of the kernel symbols.
+#
+# If the fragment already exists from a previous build with the same major
+# version, every service in it must still be at the same address. Otherwise,
+# modules already built against the old table would break, so this stops with
+# an error.
+#
+# If the ELF has no service table, any existing fragment is removed.
+#
+# Usage:
+#   kernel_table.sh [-n name] <kernel.elf> <fragment.ld>
+#
+# Set NM in the environment to choose the symbol lister.
+
+NM=${NM:-m68k-linux-gnu-nm}
+
+name=
+
+while getopts "n:" opt; do
+	case $opt in
+		n) name=$OPTARG ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -ne 2 ]; then
+	echo "Usage: $0 [-n name] <kernel.elf> <fragment.ld>" >&2
+	exit 2
+fi
+
+elf=$1
+out=$2
+[ -n "$name" ] || name=$(basename "$elf")
+
+syms=$($NM -n "$elf") || exit 1
+
+if ! echo "$syms" | grep -q ' kernel_table$'; then
+	rm -f "$out"
+	exit 0
+fi
+
+old=
+[ -f "$out" ] && old=$(cat "$out")
+
+echo "$syms" | awk -v name="$name" -v elf="$(basename "$elf")" -v out="$out" -v old="$old" '
+function hex(s,    i, c, v) {
+	v = 0
+	s = tolower(s)
+	for (i = 1; i <= length(s); i++) {
+		c = index("0123456789abcdef", substr(s, i, 1))
+		v = v * 16 + c - 1
+	}
+	return v
+}
+
+$3 == "kernel_table" {
+	table = $1
+	next
+}
+
+$3 == "kernel_table_version" {
+	version = hex($1)
+	next
+}
+
+$2 == "T" && $3 ~ /^kernel_table_/ {
+	svc = substr($3, 14)
+	addr[svc] = $1
+	order[++count] = svc
+}
+
+END {
+	# services from the previous build
+	n = split(old, lines, "\n")
+	old_version = -1
+	for (i = 1; i <= n; i++) {
+		if (split(lines[i], f, /[ =;]+/) < 2)
+			continue
+		if (f[1] == "kernel_table_version")
+			old_version = hex(substr(f[2], 3))
+		else if (f[1] != "kernel_table" && f[1] !~ /^\//)
+			old_addr[f[1]] = f[2]
+	}
+
+	if (old_version >= 0 && int(old_version / 256) == int(version / 256)) {
+		for (svc in old_addr) {
+			if (!(svc in addr)) {
+				printf "%s: service %s was removed from the table without a new major version\n", name, svc > "/dev/stderr"
+				bad = 1
+			} else if (hex(substr(old_addr[svc], 3)) != hex(addr[svc])) {
+				printf "%s: service %s moved in the table without a new major version\n", name, svc > "/dev/stderr"
+				bad = 1
+			}
+		}
+		if (bad)
+			exit 1
+	}
+
+	printf "/* Kernel service table from %s, generated by kernel_table.sh */\n", elf > out
+	printf "kernel_table = 0x%s;\n", table > out
+	printf "kernel_table_version = 0x%04x;\n", version > out
+	for (i = 1; i <= count; i++)
+		printf "%s = 0x%s;\n", order[i], addr[order[i]] > out
+
+	printf "%s: kernel service table version %d.%d with %d services\n", \
+		name, int(version / 256), version % 256, count > "/dev/stderr"
+}'
@@ -0,0 +1,198 @@
+#!/bin/sh
+#
+# [ M E G A D E V ]   a Sega Mega CD devkit
+#
+# mmd_compress.sh
+# Compress the payload of an MMD module which has the compressed flag set
+#
+# The module header (0x100 bytes) and the .init section are left as they are,
+# so that self-copying modules (such as the IPX) can still run their .init code
+# from Word RAM. Everything after .init is replaced with:
+#
+#   long   Length of the compressed data (a multiple of 4)
+#   long   Space needed to unpack the module in place (see below)
+#   ...    Kosinski compressed data, padded to a multiple of 4
+#
+# A module which runs in place (MMD_DEST of 0) is unpacked by first moving the
+# compressed data to the end of the in place space, then unpacking it to the
+# start. The space is large enough that the output never catches up with the
+# input.
+#
+# Modules without the flag are not modified, so this can be run on every
+# module.
+#
+# Usage:
+#   mmd_compress.sh [-n name] <module.mmd>
+#
+# Requires od and xxd.
+
+name=
+
+while getopts "n:" opt; do
+	case $opt in
+		n) name=$OPTARG ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -ne 1 ]; then
+	echo "Usage: $0 [-n name] <module.mmd>" >&2
+	exit 2
+fi
+
+mmd=$1
+[ -n "$name" ] || name=$(basename "$mmd")
+
+# MMD_BIT_COMPRESSED in main/mmd.def.h, within the first byte of the flags
+flags=$(od -An -tu1 -N1 "$mmd" | tr -d ' ')
+[ $((flags & 0x20)) -ne 0 ] || exit 0
+
+tmp="$mmd.tmp"
+
+od -An -v -tu1 "$mmd" | awk -v name="$name" '
+function bit(b) {
+	if (b)
+		desc += pow2[nbits]
+	nbits++
+	if (nbits == 16) {
+		out[descpos] = desc % 256
+		out[descpos + 1] = int(desc / 256)
+		desc = 0
+		nbits = 0
+		descpos = olen
+		olen += 2
+	}
+}
+
+function byte(b) {
+	out[olen++] = b
+}
+
+function track() {
+	if (done - olen > maxdiff)
+		maxdiff = done - olen
+}
+
+function hdr_long(at) {
+	return ((data[at] * 256 + data[at + 1]) * 256 + data[at + 2]) * 256 + data[at + 3]
+}
+
+function put_long(v, a) {
+	for (a = 3; a >= 0; a--) {
+		printf "%02x", int(v / pow2[a * 8]) % 256
+	}
+}
+
+{
+	for (i = 1; i <= NF; i++)
+		data[n++] = $i + 0
+}
+
+END {
+	for (i = 0; i <= 24; i++)
+		pow2[i] = 2 ^ i
+
+	# MMD_HEADER_INIT_LENGTH
+	init_len = hdr_long(20)
+	start = 256 + init_len
+	if (start > n) {
+		printf "%s: .init is larger than the module\n", name > "/dev/stderr"
+		exit 1
+	}
+
+	ulen = n - start
+	olen = 2
+	descpos = 0
+	desc = 0
+	nbits = 0
+	done = 0
+	maxdiff = 0
+
+	p = start
+	while (p < n) {
+		best = 0
+		dist = 0
+		if (p + 2 < n) {
+			key = (data[p] * 256 + data[p + 1]) * 256 + data[p + 2]
+			c = (key in head) ? head[key] : -1
+			tries = 0
+			while (c >= 0 && p - c <= 8192 && tries < 32) {
+				l = 0
+				while (l < 256 && p + l < n && data[c + l] == data[p + l])
+					l++
+				if (l > best) {
+					best = l
+					dist = p - c
+					if (l == 256)
+						break
+				}
+				c = (c in prev) ? prev[c] : -1
+				tries++
+			}
+		}
+
+		if (best >= 3 && best <= 5 && dist <= 256) {
+			# inline: 0 0, two count bits, one byte of offset
+			bit(0); bit(0)
+			bit(int((best - 2) / 2)); bit((best - 2) % 2)
+			byte(256 - dist)
+		} else if (best >= 3) {
+			# separate: 0 1, two or three bytes
+			off = 8192 - dist
+			bit(0); bit(1)
+			byte(off % 256)
+			if (best <= 9) {
+				byte(int(off / 256) * 8 + best - 2)
+			} else {
+				byte(int(off / 256) * 8)
+				byte(best - 1)
+			}
+		} else {
+			best = 1
+			bit(1)
+			byte(data[p])
+		}
+
+		for (e = p + best; p < e; p++) {
+			if (p + 2 < n) {
+				key = (data[p] * 256 + data[p + 1]) * 256 + data[p + 2]
+				if (key in head)
+					prev[p] = head[key]
+				head[key] = p
+			}
+		}
+		done += best
+		track()
+	}
+
+	# end of data
+	bit(0); bit(1)
+	byte(0); byte(240); byte(0)
+	out[descpos] = desc % 256
+	out[descpos + 1] = int(desc / 256)
+	while (olen % 4)
+		byte(0)
+	track()
+
+	space = maxdiff + olen
+	if (space < ulen)
+		space = ulen
+	if (space < olen + 8)
+		space = olen + 8
+	while (space % 4)
+		space++
+
+	for (i = 0; i < start; i++)
+		printf "%02x", data[i]
+	put_long(olen)
+	put_long(space)
+	for (i = 0; i < olen; i++)
+		printf "%02x", out[i]
+	printf "\n"
+
+	printf "%s: payload compressed from %d to %d bytes (%d%%)\n", \
+		name, ulen, olen + 8, ulen ? int((olen + 8) * 100 / ulen) : 0 > "/dev/stderr"
+}' | xxd -r -p > "$tmp" || { rm -f "$tmp"; exit 1; }
+
+mv "$tmp" "$mmd"
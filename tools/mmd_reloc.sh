@@ -0,0 +1,262 @@
+#!/bin/sh
+#
+# [ M E G A D E V ]   a Sega Mega CD devkit
+#
+# mmd_reloc.sh
+# Add a relocation table to an MMD module which has the relocatable flag set
+#
+# The module must be linked with relocations kept (ld -q). Every absolute long
+# in .rom or .ram_data which points into .rom is listed in the table, so that
+# the loader can move the module by adding the difference between the new and
+# the linked address to each of them (see main/mmd.def.h).
+#
+# The table is appended to the module data and included in the header copy
+# count, so it is copied (or unpacked) along with the module. Its offset from
+# the start of the module data is stored in the header.
+#
+# Table encoding, one entry per relocated long, each relative to the previous
+# one (or to two bytes before the start of the module data, so that the first
+# advance is never 0):
+#
+#   00              End of table
+#   01 to 7F        Advance by (value * 2) bytes and relocate
+#   8x xx           Advance by ((value & 0x7FFF) * 2) bytes and relocate
+#   80 00           Advance by 0xFFFE bytes without relocating
+#
+# A skip is one word short of the longest advance, so the advance which
+# follows the skips is never 0.
+#
+# Modules without the flag are not modified, so this can be run on every
+# module.
+#
+# Usage:
+#   mmd_reloc.sh [-n name] <module.elf> <module.mmd>
+#
+# Set READELF in the environment to choose the ELF reader. Requires od and xxd.
+
+READELF=${READELF:-m68k-linux-gnu-readelf}
+
+name=
+
+while getopts "n:" opt; do
+	case $opt in
+		n) name=$OPTARG ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -ne 2 ]; then
+	echo "Usage: $0 [-n name] <module.elf> <module.mmd>" >&2
+	exit 2
+fi
+
+elf=$1
+mmd=$2
+[ -n "$name" ] || name=$(basename "$mmd")
+
+# MMD_BIT_RELOCATABLE in main/mmd.def.h, within the first byte of the flags
+flags=$(od -An -tu1 -N1 "$mmd" | tr -d ' ')
+[ $((flags & 0x10)) -ne 0 ] || exit 0
+
+tmp="$mmd.tmp"
+relocs="$mmd.relocs"
+rm -f "$tmp.info"
+
+{
+	$READELF -S -W "$elf" || exit 1
+	$READELF -r -W "$elf" || exit 1
+} > "$relocs" || { rm -f "$relocs"; exit 1; }
+
+od -An -v -tu1 "$mmd" | awk -v name="$name" '
+function hex(s,    i, c, v) {
+	v = 0
+	s = tolower(s)
+	for (i = 1; i <= length(s); i++) {
+		c = index("0123456789abcdef", substr(s, i, 1))
+		if (c == 0)
+			return -1
+		v = v * 16 + c - 1
+	}
+	return v
+}
+
+function img_long(at) {
+	at += 256
+	return ((data[at] * 256 + data[at + 1]) * 256 + data[at + 2]) * 256 + data[at + 3]
+}
+
+function put_byte(v) {
+	printf "%02x", v
+	table[tlen++] = v
+}
+
+function put_word(v) {
+	put_byte(int(v / 256) % 256)
+	put_byte(v % 256)
+}
+
+function fail(msg) {
+	printf "%s: %s\n", name, msg > "/dev/stderr"
+	exit 1
+}
+
+# section headers and relocations from readelf
+NR == FNR {
+	if ($0 ~ /^Relocation section/) {
+		sect = $3
+		gsub(/'\''/, "", sect)
+		next
+	}
+	if (sect == "") {
+		for (i = 1; i < NF; i++) {
+			if ($i == ".rom" || $i == ".ram_data") {
+				vma[$i] = hex($(i + 2))
+				size[$i] = hex($(i + 4))
+			}
+		}
+		next
+	}
+	if (sect != ".rela.rom" && sect != ".rela.ram_data")
+		next
+	if (hex($1) < 0 || $3 !~ /^R_68K_/)
+		next
+	nrel++
+	rel_off[nrel] = hex($1)
+	rel_type[nrel] = $3
+	next
+}
+
+{
+	for (i = 1; i <= NF; i++)
+		data[n++] = $i + 0
+}
+
+END {
+	if (!(".rom" in vma))
+		fail("no .rom section in the ELF")
+
+	rom_start = vma[".rom"]
+	rom_end = rom_start + size[".rom"]
+	data_start = vma[".ram_data"]
+	data_end = data_start + size[".ram_data"]
+
+	# MMD_HEADER_COPY_COUNT
+	img_len = ((data[6] * 256 + data[7]) + 1) * 4
+	if (n != 256 + img_len)
+		fail("module size does not match the header copy count")
+
+	count = 0
+	for (r = 1; r <= nrel; r++) {
+		off = rel_off[r]
+		if (off >= rom_start && off < rom_end) {
+			at = off - rom_start
+		} else if (off >= data_start && off < data_end) {
+			at = size[".rom"] + off - data_start
+		} else {
+			continue
+		}
+
+		type = rel_type[r]
+		if (type == "R_68K_32") {
+			# the end of .rom is included, for _ROM_DATA_ORIGIN
+			value = img_long(at)
+			if (value < rom_start || value > rom_end)
+				continue
+			if (at % 2)
+				fail(sprintf("unaligned pointer at 0x%X", off))
+			sites[count++] = at
+		} else if (type == "R_68K_16" || type == "R_68K_8") {
+			fail(sprintf("%s at 0x%X cannot be relocated", type, off))
+		} else if (type == "R_68K_PC16" && off < rom_end && off >= rom_start) {
+			# pc relative references out of the module would be broken by a move
+			value = data[256 + at] * 256 + data[256 + at + 1]
+			if (value >= 32768)
+				value -= 65536
+			value += off
+			if (value < rom_start || value > rom_end)
+				fail(sprintf("PC relative reference out of the module at 0x%X", off))
+		}
+	}
+
+	# sort (sites are mostly in order already)
+	for (i = 1; i < count; i++) {
+		v = sites[i]
+		for (j = i - 1; j >= 0 && sites[j] > v; j--)
+			sites[j + 1] = sites[j]
+		sites[j + 1] = v
+	}
+
+	for (i = 0; i < n; i++)
+		printf "%02x", data[i]
+
+	tlen = 0
+	nuniq = 0
+	pos = -2
+	for (i = 0; i < count; i++) {
+		if (i > 0 && sites[i] == sites[i - 1])
+			continue
+		d = (sites[i] - pos) / 2
+		while (d > 32767) {
+			put_word(32768)
+			d -= 32767
+		}
+		if (d < 128)
+			put_byte(d)
+		else
+			put_word(32768 + d)
+		pos = sites[i]
+		uniq[nuniq++] = pos
+	}
+	put_byte(0)
+	while (tlen % 4)
+		put_byte(0)
+	printf "\n"
+
+	# read the table back as the loader does, to check the encoding
+	pos = -2
+	j = 0
+	for (i = 0; table[i] != 0; i++) {
+		v = table[i]
+		if (v >= 128) {
+			v = (v - 128) * 256 + table[++i]
+			if (v == 0) {
+				pos += 65534
+				continue
+			}
+		}
+		pos += v * 2
+		if (j >= nuniq || pos != uniq[j++])
+			fail(sprintf("relocation table does not decode at entry %d", j))
+	}
+	if (j != nuniq)
+		fail("relocation table is cut short")
+
+	# for the header patches below
+	printf "%d %d %d %d\n", img_len, (img_len + tlen) / 4 - 1, count, tlen > info
+}' info="$tmp.info" "$relocs" - | xxd -r -p > "$tmp"
+
+rm -f "$relocs"
+if [ ! -s "$tmp.info" ]; then
+	rm -f "$tmp" "$tmp.info"
+	exit 1
+fi
+set -- $(cat "$tmp.info")
+rm -f "$tmp.info"
+
+img_len=$1
+copy_count=$2
+
+if [ "$copy_count" -gt 65535 ]; then
+	echo "$name: module is too large with the relocation table" >&2
+	rm -f "$tmp"
+	exit 1
+fi
+
+# MMD_HEADER_COPY_COUNT and MMD_HEADER_RELOC
+printf '%04x' "$copy_count" | xxd -r -p | dd of="$tmp" bs=1 seek=6 conv=notrunc 2>/dev/null
+printf '%08x' "$img_len" | xxd -r -p | dd of="$tmp" bs=1 seek=24 conv=notrunc 2>/dev/null
+
+mv "$tmp" "$mmd"
+
+echo "$name: $3 relocations in $4 bytes" >&2
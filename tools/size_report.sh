@@ -0,0 +1,283 @@
+#!/bin/sh
+#
+# [ M E G A D E V ]   a Sega Mega CD devkit
+#
+# size_report.sh
+# Memory usage report for a linked module
+#
+# Compares the section lengths exported by the linker script (_ROM_LENGTH,
+# _BSS_LENGTH, _RAM_DATA_LENGTH) against the sizes declared by the module
+# (MODULE_ROM_LENGTH, MODULE_RAM_LENGTH), and lists the largest symbols and
+# object files. For modules that are loaded from disc, the number of 2048 byte
+# sectors is shown as well, since load time is proportional to it.
+#
+# A machine readable summary ("key value" per line) can be kept between builds.
+# If one exists from the previous build, the changes are listed and written to
+# a diff file ("key old new delta" per line).
+#
+# Usage:
+#   size_report.sh [options] <module.elf> [object.o ...]
+#
+# Options:
+#   -n <name>     Module name for messages (default: ELF filename)
+#   -t <count>    Number of symbols/objects to list (default: 10)
+#   -s <file>     Final binary, for the disc sector count
+#   -m <file>     Machine readable summary; the previous copy is diffed
+#   -d <file>     Write the changes since the previous build to this file
+#   -o <file>     Write the full report to this file instead of stdout
+#
+# Set NM and SIZE in the environment to choose the binutils programs.
+
+NM=${NM:-m68k-linux-gnu-nm}
+SIZE=${SIZE:-m68k-linux-gnu-size}
+
+name=
+top=10
+bin=
+machine=
+diff=
+out=
+
+while getopts "n:t:s:m:d:o:" opt; do
+	case $opt in
+		n) name=$OPTARG ;;
+		t) top=$OPTARG ;;
+		s) bin=$OPTARG ;;
+		m) machine=$OPTARG ;;
+		d) diff=$OPTARG ;;
+		o) out=$OPTARG ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 [-n name] [-t count] [-s binary] [-m summary] [-d diff] [-o report] <module.elf> [object.o ...]" >&2
+	exit 2
+fi
+
+elf=$1
+shift
+[ -z "$name" ] && name=$(basename "$elf")
+
+tmp=${TMPDIR:-/tmp}/size_report.$$
+trap 'rm -f "$tmp".*' EXIT INT TERM
+
+"$NM" -S -n "$elf" > "$tmp.nm" || exit 2
+
+: > "$tmp.size"
+for obj in "$@"; do
+	[ -f "$obj" ] && "$SIZE" "$obj" | tail -n +2 >> "$tmp.size"
+done
+
+bin_size=
+[ -n "$bin" ] && [ -f "$bin" ] && bin_size=$(wc -c < "$bin")
+
+prev="$tmp.prev"
+: > "$prev"
+[ -n "$machine" ] && [ -f "$machine" ] && cp "$machine" "$prev"
+
+[ -n "$out" ] && exec 3> "$out" || exec 3>&1
+
+awk \
+	-v name="$name" \
+	-v top="$top" \
+	-v bin_size="$bin_size" \
+	-v machine="$tmp.new" \
+	-v diff="$diff" \
+	-v prevfile="$prev" \
+	-v nmfile="$tmp.nm" \
+	'
+function hex(s,    n, i)
+{
+	s = tolower(s)
+	n = 0
+	for (i = 1; i <= length(s); ++i)
+		n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+	return n
+}
+
+# first defined symbol from a space separated list of alternatives
+function sym(list,    a, n, i)
+{
+	n = split(list, a, " ")
+	for (i = 1; i <= n; ++i)
+		if (a[i] in abs)
+			return abs[a[i]]
+	return -1
+}
+
+function usage(label, used, total)
+{
+	if (used < 0)
+		return
+	if (total > 0)
+		printf("  %-12s %8d / %8d  (%5.1f%%)\n", label, used, total, used * 100 / total) > "/dev/fd/3"
+	else
+		printf("  %-12s %8d\n", label, used) > "/dev/fd/3"
+}
+
+function put(key, val)
+{
+	if (val < 0)
+		return
+	cur[key] = val
+	keys[++nkeys] = key
+	print key, val > machine
+}
+
+# sort idx[1..n] by val[] descending (the lists are short)
+function sort_desc(idx, val, n,    i, j, t)
+{
+	for (i = 2; i <= n; ++i)
+		for (j = i; j > 1 && val[idx[j]] > val[idx[j - 1]]; --j)
+		{
+			t = idx[j]
+			idx[j] = idx[j - 1]
+			idx[j - 1] = t
+		}
+}
+
+FILENAME == prevfile {
+	had_prev = 1
+	prev[$1] = $2
+	next
+}
+
+# "addr size type name" or "addr type name"
+FILENAME == nmfile {
+	if (NF == 3 && ($2 == "A" || $2 == "a"))
+		abs[$3] = hex($1)
+	else if (NF == 4 && $3 !~ /^[Aa]$/)
+	{
+		if (!($4 in symsize))
+			symidx[++nsyms] = $4
+		symsize[$4] = hex($2)
+	}
+	next
+}
+
+# size: "text data bss dec hex filename"
+NF >= 6 {
+	obj = $6
+	sub(/.*\//, "", obj)
+	if (!(obj in objsize))
+		objidx[++nobjs] = obj
+	objsize[obj] = $4
+	objtext[obj] = $1
+	objdata[obj] = $2
+	objbss[obj] = $3
+}
+
+END {
+	rom = sym("_ROM_LENGTH _rom_len")
+	bss = sym("_BSS_LENGTH _bss_len")
+	data = sym("_RAM_DATA_LENGTH _data_len")
+	rom_total = sym("MODULE_ROM_LENGTH")
+	ram_total = sym("MODULE_RAM_LENGTH")
+
+	# initialized data is stored in the ROM area and copied to RAM at startup
+	rom_used = (rom < 0) ? -1 : rom + (data > 0 ? data : 0)
+	ram_used = (bss < 0 && data < 0) ? -1 : (bss > 0 ? bss : 0) + (data > 0 ? data : 0)
+
+	printf("Memory usage for %s\n", name) > "/dev/fd/3"
+	usage("ROM", rom_used, rom_total)
+	usage("  .text", sym("_TEXT_LENGTH _text_len"), -1)
+	usage("  .rodata", sym("_RODATA_LENGTH"), -1)
+	usage("  .data", data, -1)
+	usage("RAM", ram_used, ram_total)
+	usage("  .bss", bss, -1)
+	usage("  .data", data, -1)
+
+	sectors = -1
+	if (bin_size != "")
+	{
+		sectors = int((bin_size + 2047) / 2048)
+		printf("  %-12s %8d  (%d bytes)\n", "sectors", sectors, bin_size) > "/dev/fd/3"
+	}
+
+	put("rom_used", rom_used)
+	put("rom_total", rom_total)
+	put("ram_used", ram_used)
+	put("ram_total", ram_total)
+	put("bss", bss)
+	put("data", data)
+	put("sectors", sectors)
+
+	if (nsyms > 0)
+	{
+		sort_desc(symidx, symsize, nsyms)
+		printf("\n  Largest symbols\n") > "/dev/fd/3"
+		for (i = 1; i <= nsyms && i <= top; ++i)
+			printf("  %8d  %s\n", symsize[symidx[i]], symidx[i]) > "/dev/fd/3"
+		for (i = 1; i <= nsyms; ++i)
+			put("sym:" symidx[i], symsize[symidx[i]])
+	}
+
+	if (nobjs > 0)
+	{
+		sort_desc(objidx, objsize, nobjs)
+		printf("\n  Largest objects      text     data      bss\n") > "/dev/fd/3"
+		for (i = 1; i <= nobjs && i <= top; ++i)
+		{
+			o = objidx[i]
+			printf("  %-16s %8d %8d %8d\n", o, objtext[o], objdata[o], objbss[o]) > "/dev/fd/3"
+		}
+		for (i = 1; i <= nobjs; ++i)
+			put("obj:" objidx[i], objsize[objidx[i]])
+	}
+
+	# changes since the previous build
+	nchanges = 0
+	for (k in prev)
+		if (!(k in cur))
+			changes[++nchanges] = k " " prev[k] " 0 " (-prev[k])
+	for (i = 1; i <= nkeys; ++i)
+	{
+		k = keys[i]
+		if (k in prev)
+		{
+			if (prev[k] != cur[k])
+				changes[++nchanges] = k " " prev[k] " " cur[k] " " (cur[k] - prev[k])
+		}
+		else if (had_prev)
+			changes[++nchanges] = k " 0 " cur[k] " " cur[k]
+	}
+
+	if (diff != "")
+		printf("") > diff
+	if (nchanges > 0)
+	{
+		printf("\n  Changes since the previous build\n") > "/dev/fd/3"
+		for (i = 1; i <= nchanges; ++i)
+		{
+			split(changes[i], c, " ")
+			printf("  %+8d  %s\n", c[4], c[1]) > "/dev/fd/3"
+			if (diff != "")
+				print changes[i] > diff
+		}
+	}
+
+	# one line summary for the build log
+	line = name ":"
+	if (rom_used >= 0)
+		line = line sprintf(" ROM %d", rom_used) (rom_total > 0 ? sprintf(" (%.1f%%)", rom_used * 100 / rom_total) : "")
+	if (ram_used >= 0)
+		line = line sprintf(" RAM %d", ram_used) (ram_total > 0 ? sprintf(" (%.1f%%)", ram_used * 100 / ram_total) : "")
+	if (sectors >= 0)
+		line = line sprintf(" %d sectors", sectors)
+	if ("rom_used" in prev && rom_used >= 0 && prev["rom_used"] != rom_used)
+		line = line sprintf(", ROM %+d since last build", rom_used - prev["rom_used"])
+	if ("ram_used" in prev && ram_used >= 0 && prev["ram_used"] != ram_used)
+		line = line sprintf(", RAM %+d since last build", ram_used - prev["ram_used"])
+	print line
+
+	if (rom_total > 0 && rom_used > rom_total)
+		printf("%s: ROM usage exceeds MODULE_ROM_LENGTH by %d bytes\n", name, rom_used - rom_total)
+	if (ram_total > 0 && ram_used > ram_total)
+		printf("%s: RAM usage exceeds MODULE_RAM_LENGTH by %d bytes\n", name, ram_used - ram_total)
+}
+' "$prev" "$tmp.nm" "$tmp.size" || exit 2
+
+[ -n "$machine" ] && mv "$tmp.new" "$machine"
+exit 0
@@ -0,0 +1,110 @@
+#!/bin/sh
+#
+# [ M E G A D E V ]   a Sega Mega CD devkit
+#
+# sprdef.sh
+# Make a metasprite layout for the sprite engine from a .sprdef file
+#
+# Each line of a .sprdef file describes one hardware sprite cut from the
+# source image, in cells:
+#
+#   x,y,width,height[,order]
+#
+# The tiles of the sprites are expected one after the other in the converted
+# graphics, by order if it is given, otherwise in the order of the lines. The
+# layout lists the sprites in that same order. See main/sprite.def.h for the
+# layout format.
+#
+# Offsets are relative to the origin of the metasprite, which is the top left
+# of the image unless set with -x and -y (in pixels). Flipping a metasprite
+# mirrors it around its origin.
+#
+# Usage:
+#   sprdef.sh [-x origin_x] [-y origin_y] <in.sprdef> <out>
+#
+# Requires xxd.
+
+ox=0
+oy=0
+
+while getopts "x:y:" opt; do
+	case $opt in
+		x) ox=$OPTARG ;;
+		y) oy=$OPTARG ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -ne 2 ]; then
+	echo "Usage: $0 [-x origin_x] [-y origin_y] <in.sprdef> <out>" >&2
+	exit 2
+fi
+
+tmp="$2.tmp"
+
+tr -d '\r' < "$1" | awk -F, -v ox="$ox" -v oy="$oy" -v name="$(basename "$1")" '
+function word(v) {
+	if (v < 0)
+		v += 65536
+	printf "%02x%02x", int(v / 256), v % 256
+}
+
+function fail(msg) {
+	printf "%s:%d: %s\n", name, NR, msg > "/dev/stderr"
+	bad = 1
+	exit 1
+}
+
+/^[ \t]*(#|$)/ { next }
+
+{
+	for (i = 1; i <= NF; i++)
+		gsub(/[ \t]/, "", $i)
+	if (NF < 4 || NF > 5)
+		fail("expected x,y,width,height[,order]")
+	if ($3 < 1 || $3 > 4 || $4 < 1 || $4 > 4)
+		fail("sprites are 1 to 4 cells wide and high")
+	n++
+	x[n] = $1 * 8 - ox
+	y[n] = $2 * 8 - oy
+	w[n] = $3 + 0
+	h[n] = $4 + 0
+	order[n] = (NF == 5) ? $5 + 0 : n
+}
+
+END {
+	if (bad)
+		exit 1
+	if (n == 0) {
+		printf "%s: no sprites\n", name > "/dev/stderr"
+		exit 1
+	}
+
+	# by order, keeping lines with the same order as they are
+	for (i = 1; i <= n; i++)
+		idx[i] = i
+	for (i = 2; i <= n; i++) {
+		v = idx[i]
+		for (j = i - 1; j >= 1 && order[idx[j]] > order[v]; j--)
+			idx[j + 1] = idx[j]
+		idx[j + 1] = v
+	}
+
+	word(n)
+	tile = 0
+	for (i = 1; i <= n; i++) {
+		s = idx[i]
+		word(y[s])
+		word(-(y[s] + h[s] * 8))
+		word(x[s])
+		word(-(x[s] + w[s] * 8))
+		word((((w[s] - 1) * 4 + h[s] - 1) * 4096) + tile)
+		tile += w[s] * h[s]
+	}
+	printf "\n"
+
+	printf "%s: %d sprites, %d tiles\n", name, n, tile > "/dev/stderr"
+}' | xxd -r -p > "$tmp" && [ -s "$tmp" ] || { rm -f "$tmp"; exit 1; }
+
+mv "$tmp" "$2"
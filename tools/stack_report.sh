@@ -0,0 +1,288 @@
+#!/bin/sh
+#
+# [ M E G A D E V ]   a Sega Mega CD devkit
+#
+# stack_report.sh
+# Worst case stack depth analysis for a linked module
+#
+# Builds a call graph from the disassembly of the module ELF and combines it
+# with the per-function frame sizes from the GCC -fstack-usage (.su) files.
+# The deepest path is calculated for each entry point and each interrupt
+# handler. The module total is the deepest entry point plus every interrupt
+# handler stacked on top of it (each with the cost of the exception frame and
+# register save), as they may all nest in the worst case.
+#
+# Usage:
+#   stack_report.sh [options] <module.elf> [file.su ...]
+#
+# Options:
+#   -n <name>     Module name for messages (default: ELF filename)
+#   -b <bytes>    Stack budget; exit with status 1 if the total exceeds it
+#   -e <list>     Entry point symbols (default: "main")
+#   -i <list>     Interrupt handler symbols (default: none)
+#   -f <bytes>    Interrupt entry overhead (default: 66, which is the 6 byte
+#                 exception frame plus a full movem of d0-d7/a0-a6)
+#   -o <file>     Write the full report to this file instead of stdout
+#
+# Set OBJDUMP in the environment to choose the disassembler.
+#
+# Limitations:
+# - Functions without a .su entry (i.e. asm routines) count their call return
+#   address only; pushes within asm are not seen
+# - Indirect calls (jsr (a0), function pointers) cannot be followed and are
+#   marked with '?' in the report
+# - Recursion makes the depth unbounded and is reported as an error when a
+#   budget is set
+
+OBJDUMP=${OBJDUMP:-m68k-linux-gnu-objdump}
+
+name=
+budget=
+entries=main
+irqs=
+irq_frame=66
+out=
+
+while getopts "n:b:e:i:f:o:" opt; do
+	case $opt in
+		n) name=$OPTARG ;;
+		b) budget=$OPTARG ;;
+		e) entries=$OPTARG ;;
+		i) irqs=$OPTARG ;;
+		f) irq_frame=$OPTARG ;;
+		o) out=$OPTARG ;;
+		*) exit 2 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 [-n name] [-b budget] [-e entries] [-i irqs] [-f irq_frame] [-o report] <module.elf> [file.su ...]" >&2
+	exit 2
+fi
+
+elf=$1
+shift
+[ -z "$name" ] && name=$(basename "$elf")
+
+# only pass along the .su files that actually exist (asm sources have none)
+su_files=
+for su in "$@"; do
+	[ -f "$su" ] && su_files="$su_files $su"
+done
+
+tmp=${TMPDIR:-/tmp}/stack_report.$$
+trap 'rm -f "$tmp"' EXIT INT TERM
+
+"$OBJDUMP" -d "$elf" > "$tmp" || exit 2
+
+[ -n "$out" ] && exec 3> "$out" || exec 3>&1
+
+# shellcheck disable=SC2086
+awk \
+	-v name="$name" \
+	-v budget="$budget" \
+	-v entries="$entries" \
+	-v irqs="$irqs" \
+	-v irq_frame="$irq_frame" \
+	-v disasm="$tmp" \
+	'
+# strip "+0x12" offsets from a symbol reference
+function base_sym(s)
+{
+	sub(/\+.*/, "", s)
+	return s
+}
+
+# worst case depth of f, including its own frame
+function depth(f,    i, n, c, d, best, bestc)
+{
+	if (f in memo)
+		return memo[f]
+	if (f in visiting)
+	{
+		recursive[f] = 1
+		return -1
+	}
+	visiting[f] = 1
+	best = 0
+	bestc = ""
+	n = ncallees[f] + 0
+	for (i = 1; i <= n; ++i)
+	{
+		c = callee[f, i]
+		d = depth(c)
+		if (d < 0)
+		{
+			delete visiting[f]
+			recursive[f] = 1
+			memo[f] = -1
+			return -1
+		}
+		d += cost[f, i]
+		if (d > best || bestc == "")
+		{
+			best = d
+			bestc = c
+		}
+	}
+	delete visiting[f]
+	next_on_path[f] = bestc
+	memo[f] = frame[f] + best
+	return memo[f]
+}
+
+function path(f,    s)
+{
+	s = f
+	while (next_on_path[f] != "")
+	{
+		f = next_on_path[f]
+		s = s " > " f
+	}
+	return s
+}
+
+function has_indirect(f,    seen)
+{
+	while (f != "")
+	{
+		if (f in indirect)
+			return 1
+		if (f in seen)
+			return 0
+		seen[f] = 1
+		f = next_on_path[f]
+	}
+	return 0
+}
+
+function add_edge(f, c, bytes,    k)
+{
+	if (c == f || ((f, c) in edge))
+		return
+	edge[f, c] = 1
+	k = ++ncallees[f]
+	callee[f, k] = c
+	cost[f, k] = bytes
+}
+
+function report(f, kind, extra,    d, flag)
+{
+	if (!(f in funcs))
+		return -2
+	d = depth(f)
+	if (d < 0)
+	{
+		printf("  %-24s %8s  %s\n", f, "RECURSE", kind) > "/dev/fd/3"
+		return -1
+	}
+	flag = has_indirect(f) ? "?" : " "
+	printf("  %-24s %7d%s  %s\n", f, d + extra, flag, kind) > "/dev/fd/3"
+	printf("    %s\n", path(f)) > "/dev/fd/3"
+	return d + extra
+}
+
+# .su lines: "file.c:12:6:func_name<TAB>bytes<TAB>qualifiers"
+FILENAME != disasm {
+	split($0, fld, "\t")
+	n = split(fld[1], loc, ":")
+	fn = loc[n]
+	if (fld[2] + 0 > frame[fn] + 0)
+		frame[fn] = fld[2] + 0
+	if (fld[3] ~ /dynamic/)
+		dynamic[fn] = 1
+	next
+}
+
+# function label: "00200100 <main>:"
+/^[0-9a-f]+ <[^>]+>:$/ {
+	prev = cur
+	cur = $2
+	gsub(/[<>:]/, "", cur)
+	funcs[cur] = 1
+	# asm code may run from one label straight into the next
+	if (prev != "" && last != "" && last !~ /^(rts|rte|rtr|jmp|jra|jbra|bra[bswl]?)$/)
+		add_edge(prev, cur, 0)
+	last = ""
+	next
+}
+
+cur != "" && /\t/ {
+	split($0, fld, "\t")
+	ins = fld[3]
+	mnem = ins
+	sub(/[ \t].*/, "", mnem)
+	if (mnem != "")
+		last = mnem
+
+	is_call = (mnem ~ /^(jsr|jbsr|bsr[bswl]?)$/)
+	is_jump = (mnem ~ /^(jmp|j?b(ra|hi|ls|cc|hs|cs|lo|ne|eq|vc|vs|pl|mi|ge|lt|gt|le)[bswl]?)$/)
+	if (!is_call && !is_jump)
+		next
+
+	if (match(ins, /<[^>]+>/))
+	{
+		target = substr(ins, RSTART + 1, RLENGTH - 2)
+		# a jump to the middle of a function is a local branch
+		if (is_jump && target ~ /\+/)
+			next
+		# calls push the return address; tail jumps do not
+		add_edge(cur, base_sym(target), is_call ? 4 : 0)
+	}
+	else if (ins ~ /%a[0-7]|%sp|%fp|@|\(/)
+		indirect[cur] = 1
+}
+
+END {
+	printf("Stack usage for %s\n", name) > "/dev/fd/3"
+	printf("  %-24s %8s\n", "entry", "bytes") > "/dev/fd/3"
+
+	bad = 0
+	worst = 0
+	n = split(entries, list, " ")
+	for (i = 1; i <= n; ++i)
+	{
+		d = report(list[i], "entry", 0)
+		if (d == -1)
+			bad = 1
+		else if (d > worst)
+			worst = d
+	}
+
+	irq_total = 0
+	n = split(irqs, list, " ")
+	for (i = 1; i <= n; ++i)
+	{
+		d = report(list[i], "interrupt", irq_frame)
+		if (d == -1)
+			bad = 1
+		else if (d > 0)
+			irq_total += d
+	}
+
+	for (f in dynamic)
+		printf("  warning: %s uses a dynamically sized frame\n", f) > "/dev/fd/3"
+
+	total = worst + irq_total
+	if (budget != "")
+		printf("  %-24s %8d / %d\n", "worst case total", total, budget) > "/dev/fd/3"
+	else
+		printf("  %-24s %8d\n", "worst case total", total) > "/dev/fd/3"
+
+	# one line summary for the build log
+	if (bad)
+	{
+		printf("%s: recursion found, stack depth is unbounded\n", name)
+		if (budget != "")
+			exit 1
+	}
+	else if (budget != "" && total > budget + 0)
+	{
+		printf("%s: worst case stack depth %d exceeds budget of %d bytes\n", name, total, budget)
+		exit 1
+	}
+	else
+		printf("%s: worst case stack depth %d bytes\n", name, total)
+}
+' $su_files "$tmp"